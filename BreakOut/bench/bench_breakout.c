@@ -0,0 +1,423 @@
+// Headless benchmarks for the BreakOut simulation. Every case runs a fixed
+// amount of work several times and reports the median and best ns/op, the
+// throughput and, where the linker supports --wrap, heap allocations per op.
+//
+//   bench_breakout [--quick] [--repeat N] [--json file|-] [--label name]
+
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 199309L
+#endif
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#include "bot.h"
+#include "env_batch.h"
+#include "particles.h"
+#include "sim.h"
+
+#define BENCH_MAX_REPEAT 32
+#define BENCH_MAX_CASES 16
+
+typedef struct BenchResult
+{
+    const char *name;
+    const char *unit;
+    long long ops;
+    double items;
+    double nsMedian;
+    double nsMin;
+    double allocsPerOp;
+} BenchResult;
+
+// setup restores a known state before every repeat; run does `ops` operations
+// and returns how many units of `unit` they processed, for the throughput
+typedef struct BenchCase
+{
+    const char *name;
+    const char *unit;
+    long long ops;
+    void (*setup)(void);
+    double (*run)(long long ops);
+} BenchCase;
+
+static uint64_t benchNow(void)
+{
+#if defined(_WIN32)
+    static LARGE_INTEGER frequency;
+    LARGE_INTEGER counter;
+    if (!frequency.QuadPart)
+        QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return (uint64_t)(counter.QuadPart * 1000000000.0 / frequency.QuadPart);
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000u + now.tv_nsec;
+#endif
+}
+
+// Heap counters, fed by the linker wrappers when BENCH_COUNT_ALLOCS is set
+static long long allocCount;
+
+#ifdef BENCH_COUNT_ALLOCS
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+
+void *__wrap_malloc(size_t size)
+{
+    allocCount++;
+    return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t count, size_t size)
+{
+    allocCount++;
+    return __real_calloc(count, size);
+}
+
+void *__wrap_realloc(void *ptr, size_t size)
+{
+    allocCount++;
+    return __real_realloc(ptr, size);
+}
+#endif
+
+// Keeps results alive so the optimiser can't drop the work
+static volatile double sink;
+
+static GameState game;
+static Ball ball;
+static ParticleSystem particles;
+static EnvBatch envs;
+static signed char envActions[256];
+
+static int compareDoubles(const void *a, const void *b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+// Ball bouncing inside a full-width paddle so it never falls; the field is
+// regenerated whenever it is cleared
+static void setupCollisions(void)
+{
+    initGameState(&game, 900, 550, 1);
+    game.paddle.width = game.screenWidth * 2;
+    ball = (Ball){game.screenWidth / 2, game.bricks.top + BRICK_HEIGHT * game.bricks.rows + 40, BALL_SPEED * 1.3f, -BALL_SPEED, SPRITE_SIZE / 2};
+}
+
+// Ball-sized probes stepped across the field. Each one finds the live bricks
+// under it with the same row and column masks updateBall scans and hits them
+// all, so this times the bitboard lookup and hitBrick without the sweep
+static void setupBrickScan(void)
+{
+    initGameState(&game, 900, 550, 1);
+}
+
+static double runBrickScan(long long ops)
+{
+    BrickField *bricks = &game.bricks;
+    float radius = SPRITE_SIZE / 2;
+    double hits = 0;
+    for (long long i = 0; i < ops; i++)
+    {
+        float x = (float)(i * 37 % game.screenWidth);
+        float y = bricks->top + (float)(i * 13 % (bricks->rows * BRICK_HEIGHT));
+        int firstRow = rowOf(bricks, y - radius);
+        int lastRow = rowOf(bricks, y + radius);
+        if (firstRow < 0)
+            firstRow = 0;
+        if (lastRow > bricks->rows - 1)
+            lastRow = bricks->rows - 1;
+        for (int row = firstRow; row <= lastRow; row++)
+        {
+            uint64_t candidates = bricks->live[row] & columnMask(bricks, row, x - radius, x + radius);
+            while (candidates)
+            {
+                int col = lowestBit(candidates);
+                candidates &= candidates - 1;
+                hitBrick(bricks, row, col, &game.score);
+                hits++;
+            }
+        }
+        if (isLevelCleared(bricks))
+            initBricks(bricks, game.level, game.screenWidth, &game.levelRng);
+    }
+    sink = game.score;
+    return hits;
+}
+
+// Same bounce box with no bricks, so only walls, ceiling and paddle are swept
+static void setupOpenField(void)
+{
+    setupCollisions();
+    initBrickField(&game.bricks, MAX_ROWS, MAX_COLS);
+}
+
+static double runUpdateBall(long long ops)
+{
+    float dt = 1.0f / SIM_TICK_RATE;
+    unsigned int events = 0;
+    for (long long i = 0; i < ops; i++)
+    {
+        game.hitCount = 0;
+        events |= updateBall(&ball, &game.paddle, &game.bricks, game.screenWidth, dt, &game.score, game.hits, &game.hitCount);
+    }
+    sink = events + ball.x;
+    return ops;
+}
+
+// 500 balls fanned out over the field and the full-width paddle, so none are
+// lost. Throughput is counted in ball steps.
+static void setupMultiBall(void)
+{
+    setupCollisions();
+    BallSet *balls = &game.balls;
+    balls->count = 500;
+    for (int i = 0; i < balls->count; i++)
+    {
+        float angle = 0.3f + 2.5f * i / balls->count;
+        balls->x[i] = balls->radius + (float)(i * 37 % (game.screenWidth - 2 * SPRITE_SIZE));
+        balls->y[i] = game.screenHeight - 100 - (float)(i * 53 % 300);
+        balls->speedX[i] = BALL_SPEED * 1.4f * cosf(angle);
+        balls->speedY[i] = -BALL_SPEED * 1.4f * sinf(angle);
+    }
+}
+
+static double runMultiBall(long long ops)
+{
+    float dt = 1.0f / SIM_TICK_RATE;
+    unsigned int events = 0;
+    double steps = 0;
+    for (long long i = 0; i < ops; i++)
+    {
+        game.hitCount = 0;
+        steps += game.balls.count;
+        events |= updateBalls(&game.balls, &game.paddle, &game.bricks, game.screenWidth, game.screenHeight, dt, &game.gameRng, &game.score, game.hits, &game.hitCount);
+        if (isLevelCleared(&game.bricks))
+            initBricks(&game.bricks, game.level, game.screenWidth, &game.levelRng);
+    }
+    sink = events + game.score;
+    return steps;
+}
+
+// Steady state of about 10k live particles: a burst per step replaces what
+// fades out. Throughput is counted in particles updated.
+static void setupParticles(void)
+{
+    if (!particles.capacity)
+        initParticleSystem(&particles, PARTICLE_CAPACITY, 5.0f, 0.09f, 0.05f, 1);
+    clearParticleSystem(&particles);
+    ParticleColor color = {230, 41, 55, 255};
+    for (int i = 0; i < 200; i++)
+        emitParticles(&particles, 100 + i, 100, BRICK_WIDTH, BRICK_HEIGHT, color, PARTICLES_PER_BURST);
+}
+
+static double runParticles(long long ops)
+{
+    ParticleColor color = {0, 82, 172, 255};
+    double updated = 0;
+    for (long long i = 0; i < ops; i++)
+    {
+        emitParticles(&particles, 300, 200, BRICK_WIDTH, BRICK_HEIGHT, color, PARTICLES_PER_BURST);
+        updated += particles.count;
+        updateParticleSystem(&particles, 1.0f / 60);
+    }
+    sink = particles.count;
+    return updated;
+}
+
+static void setupInitBricks(void)
+{
+    initGameState(&game, 900, 550, 1);
+}
+
+static double runInitBricks(long long ops)
+{
+    for (long long i = 0; i < ops; i++)
+        initBricks(&game.bricks, 1 + i % 8, game.screenWidth, &game.levelRng);
+    sink = game.bricks.liveCount;
+    return ops;
+}
+
+// Whole state machine driven by the scripted player, one op per tick
+static void setupSession(void)
+{
+    initGameState(&game, 900, 550, 42);
+}
+
+static double runSession(long long ops)
+{
+    float dt = 1.0f / SIM_TICK_RATE;
+    for (long long i = 0; i < ops; i++)
+        stepGame(&game, botInput(&game, (unsigned int)i), dt);
+    sink = game.score;
+    return ops;
+}
+
+// 256 environments stepped together, each paddle chasing its own ball.
+// Throughput is counted in environment steps.
+static void setupEnvBatch(void)
+{
+    if (envs.count)
+        unloadEnvBatch(&envs);
+    initEnvBatch(&envs, sizeof(envActions), 900, 550, 4, 1);
+}
+
+static double runEnvBatch(long long ops)
+{
+    for (long long i = 0; i < ops; i++)
+    {
+        for (int env = 0; env < envs.count; env++)
+        {
+            float offset = envs.obs[env * ENV_OBS_SIZE + OBS_BALL_X] - envs.obs[env * ENV_OBS_SIZE + OBS_PADDLE_X];
+            envActions[env] = offset > 0.01f ? ACTION_RIGHT : offset < -0.01f ? ACTION_LEFT : ACTION_STAY;
+        }
+        stepEnvBatch(&envs, envActions);
+    }
+    sink = envs.reward[0];
+    return (double)ops * envs.count;
+}
+
+static BenchResult runCase(const BenchCase *bench, long long ops, int repeat)
+{
+    double ns[BENCH_MAX_REPEAT];
+    double items = 0;
+    long long allocs = 0;
+    for (int r = 0; r < repeat; r++)
+    {
+        bench->setup();
+        long long allocsBefore = allocCount;
+        uint64_t start = benchNow();
+        items = bench->run(ops);
+        ns[r] = (double)(benchNow() - start) / ops;
+        allocs += allocCount - allocsBefore;
+    }
+    qsort(ns, repeat, sizeof(double), compareDoubles);
+    BenchResult result = {bench->name, bench->unit, ops, items, ns[repeat / 2], ns[0], -1};
+#ifdef BENCH_COUNT_ALLOCS
+    result.allocsPerOp = (double)allocs / ((double)ops * repeat);
+#endif
+    return result;
+}
+
+static double throughput(const BenchResult *result)
+{
+    return result->items / result->ops / (result->nsMedian * 1e-9);
+}
+
+// JSON string with quotes, backslashes and control characters escaped
+static void writeJsonString(FILE *file, const char *text)
+{
+    fputc('"', file);
+    for (const unsigned char *c = (const unsigned char *)text; *c; c++)
+    {
+        if (*c == '"' || *c == '\\')
+            fprintf(file, "\\%c", *c);
+        else if (*c < 0x20)
+            fprintf(file, "\\u%04x", *c);
+        else
+            fputc(*c, file);
+    }
+    fputc('"', file);
+}
+
+static void writeJson(FILE *file, const char *label, const BenchResult results[], int count)
+{
+    fprintf(file, "{\n  \"suite\": \"bench_breakout\",\n  \"label\": ");
+    writeJsonString(file, label);
+    fprintf(file, ",\n  \"results\": [\n");
+    for (int i = 0; i < count; i++)
+    {
+        const BenchResult *r = &results[i];
+        fprintf(file, "    {\"name\": \"%s\", \"ops\": %lld, \"ns_per_op\": %.3f, \"ns_per_op_min\": %.3f, ", r->name, r->ops, r->nsMedian, r->nsMin);
+        fprintf(file, "\"throughput\": %.1f, \"throughput_unit\": \"%s/s\", ", throughput(r), r->unit);
+        if (r->allocsPerOp < 0)
+            fprintf(file, "\"allocs_per_op\": null}");
+        else
+            fprintf(file, "\"allocs_per_op\": %.4f}", r->allocsPerOp);
+        fprintf(file, "%s\n", i + 1 < count ? "," : "");
+    }
+    fprintf(file, "  ]\n}\n");
+}
+
+int main(int argc, char **argv)
+{
+    const char *jsonFile = 0;
+    const char *label = "";
+    int repeat = 7;
+    long long scale = 1;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--quick") == 0)
+            scale = 10;
+        else if (strcmp(argv[i], "--repeat") == 0 && i + 1 < argc)
+            repeat = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--json") == 0 && i + 1 < argc)
+            jsonFile = argv[++i];
+        else if (strcmp(argv[i], "--label") == 0 && i + 1 < argc)
+            label = argv[++i];
+        else
+        {
+            fprintf(stderr, "usage: %s [--quick] [--repeat N] [--json file|-] [--label name]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (repeat < 1)
+        repeat = 1;
+    if (repeat > BENCH_MAX_REPEAT)
+        repeat = BENCH_MAX_REPEAT;
+
+    const BenchCase cases[] = {
+        {"brick_collisions", "brick-hits", 2000000, setupBrickScan, runBrickScan},
+        {"update_ball", "steps", 4000000, setupOpenField, runUpdateBall},
+        {"multiball_500", "ball-steps", 20000, setupMultiBall, runMultiBall},
+        {"update_particles", "particles", 20000, setupParticles, runParticles},
+        {"init_bricks", "levels", 200000, setupInitBricks, runInitBricks},
+        {"play_session", "ticks", 4000000, setupSession, runSession},
+        {"env_batch_256", "env-steps", 20000, setupEnvBatch, runEnvBatch},
+    };
+    int count = sizeof(cases) / sizeof(cases[0]);
+    BenchResult results[BENCH_MAX_CASES];
+
+    // With the JSON on stdout the table goes to stderr, so stdout parses
+    FILE *table = jsonFile && strcmp(jsonFile, "-") == 0 ? stderr : stdout;
+    fprintf(table, "%-18s %12s %12s %10s  %s\n", "benchmark", "ns/op", "best ns/op", "allocs/op", "throughput");
+    for (int i = 0; i < count; i++)
+    {
+        results[i] = runCase(&cases[i], cases[i].ops / scale, repeat);
+        const BenchResult *r = &results[i];
+        fprintf(table, "%-18s %12.2f %12.2f ", r->name, r->nsMedian, r->nsMin);
+        if (r->allocsPerOp < 0)
+            fprintf(table, "%10s", "n/a");
+        else
+            fprintf(table, "%10.4f", r->allocsPerOp);
+        fprintf(table, "  %.3g %s/s\n", throughput(r), r->unit);
+    }
+    unloadParticleSystem(&particles);
+    unloadEnvBatch(&envs);
+
+    if (jsonFile)
+    {
+        FILE *file = strcmp(jsonFile, "-") == 0 ? stdout : fopen(jsonFile, "w");
+        if (!file)
+        {
+            printf("Could not write %s\n", jsonFile);
+            return 1;
+        }
+        writeJson(file, label, results, count);
+        if (file != stdout)
+            fclose(file);
+    }
+    return 0;
+}
@@ -0,0 +1,168 @@
+#include "asset_loader.h"
+#include "memtrack.h"
+
+#include <stdio.h>
+#include <string.h>
+
+void initAssetLoader(AssetLoader *loader, const char *packPath, const char *resourceDir)
+{
+    memset(loader, 0, sizeof(*loader));
+    loader->resourceDir = resourceDir;
+    if (!openAssetPack(&loader->pack, packPath))
+        printf("No asset pack at %s, loading assets from %s\n", packPath, resourceDir);
+}
+
+static void addRequest(AssetLoader *loader, const char *name, uint32_t type, Texture2D *texture, Sound *sound)
+{
+    if (loader->count == ASSET_LOADER_MAX)
+        return;
+    AssetRequest *request = &loader->requests[loader->count++];
+    request->name = name;
+    request->type = type;
+    request->texture = texture;
+    request->sound = sound;
+    atomic_init(&request->status, ASSET_PENDING);
+}
+
+void requestTexture(AssetLoader *loader, const char *name, Texture2D *texture)
+{
+    *texture = (Texture2D){0};
+    addRequest(loader, name, ASSET_IMAGE, texture, 0);
+}
+
+void requestSound(AssetLoader *loader, const char *name, Sound *sound)
+{
+    *sound = (Sound){0};
+    addRequest(loader, name, ASSET_WAVE, 0, sound);
+}
+
+// Packed assets are used in place; loose files are decoded with the same
+// conversion pack_assets applies
+static bool decodeRequest(AssetLoader *loader, AssetRequest *request)
+{
+    const AssetEntry *entry = findAsset(&loader->pack, request->name, request->type);
+    if (entry)
+    {
+        void *data = (void *)assetData(&loader->pack, entry);
+        if (request->type == ASSET_IMAGE)
+            request->image = (Image){data, (int)entry->params[0], (int)entry->params[1], (int)entry->params[2], (int)entry->params[3]};
+        else
+            request->wave = (Wave){entry->params[0], entry->params[1], entry->params[2], entry->params[3], data};
+        return true;
+    }
+
+    char path[512];
+    snprintf(path, sizeof(path), "%s%s", loader->resourceDir, request->name);
+    request->owned = true;
+    bool decoded;
+    int tag = memtrackPushTag(request->type == ASSET_IMAGE ? MEM_TEXTURES : MEM_AUDIO);
+    if (request->type == ASSET_IMAGE)
+    {
+        request->image = LoadImage(path);
+        if (request->image.data)
+            ImageFormat(&request->image, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+        decoded = request->image.data != 0;
+    }
+    else
+    {
+        request->wave = LoadWave(path);
+        decoded = request->wave.data != 0;
+    }
+    memtrackPopTag(tag);
+    return decoded;
+}
+
+static void *loaderThread(void *argument)
+{
+    AssetLoader *loader = argument;
+    for (;;)
+    {
+        int index = atomic_fetch_add(&loader->next, 1);
+        if (index >= loader->count)
+            return 0;
+        AssetRequest *request = &loader->requests[index];
+        bool decoded = decodeRequest(loader, request);
+        atomic_store_explicit(&request->status, decoded ? ASSET_DECODED : ASSET_FAILED, memory_order_release);
+    }
+}
+
+void startAssetLoader(AssetLoader *loader)
+{
+    for (int i = 0; i < ASSET_LOADER_THREADS && i < loader->count; i++)
+    {
+        if (pthread_create(&loader->threads[i], 0, loaderThread, loader) != 0)
+            break;
+        loader->threadCount++;
+    }
+    // Without threads everything is decoded now, which is still correct
+    if (loader->threadCount == 0)
+        loaderThread(loader);
+}
+
+static void releaseDecoded(AssetRequest *request)
+{
+    if (!request->owned)
+        return;
+    if (request->type == ASSET_IMAGE)
+        UnloadImage(request->image);
+    else
+        UnloadWave(request->wave);
+    request->owned = false;
+}
+
+int uploadLoadedAssets(AssetLoader *loader, int maxUploads)
+{
+    int uploads = 0;
+    while (loader->uploaded < loader->count && uploads < maxUploads)
+    {
+        AssetRequest *request = &loader->requests[loader->uploaded];
+        int status = atomic_load_explicit(&request->status, memory_order_acquire);
+        if (status == ASSET_PENDING)
+            break;
+        if (status == ASSET_DECODED)
+        {
+            int tag = memtrackPushTag(request->type == ASSET_IMAGE ? MEM_TEXTURES : MEM_AUDIO);
+            if (request->type == ASSET_IMAGE)
+                *request->texture = LoadTextureFromImage(request->image);
+            else
+                *request->sound = LoadSoundFromWave(request->wave);
+            releaseDecoded(request);
+            memtrackPopTag(tag);
+            atomic_store_explicit(&request->status, ASSET_DONE, memory_order_relaxed);
+            uploads++;
+        }
+        else
+            printf("Could not load asset %s\n", request->name);
+        loader->uploaded++;
+    }
+    // Everything is on the GPU or in audio buffers now, so drop the mapping
+    if (loader->uploaded == loader->count && loader->pack.base)
+        closeAssetPack(&loader->pack);
+    return uploads;
+}
+
+bool isAssetReady(const AssetLoader *loader, const void *destination)
+{
+    for (int i = 0; i < loader->uploaded; i++)
+    {
+        const AssetRequest *request = &loader->requests[i];
+        if ((const void *)request->texture == destination || (const void *)request->sound == destination)
+            return true;
+    }
+    return false;
+}
+
+float assetLoaderProgress(const AssetLoader *loader)
+{
+    return loader->count ? (float)loader->uploaded / loader->count : 1.0f;
+}
+
+void unloadAssetLoader(AssetLoader *loader)
+{
+    for (int i = 0; i < loader->threadCount; i++)
+        pthread_join(loader->threads[i], 0);
+    loader->threadCount = 0;
+    for (int i = loader->uploaded; i < loader->count; i++)
+        releaseDecoded(&loader->requests[i]);
+    closeAssetPack(&loader->pack);
+}
@@ -0,0 +1,65 @@
+#ifndef BREAKOUT_ASSET_LOADER_H
+#define BREAKOUT_ASSET_LOADER_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+
+#include "asset_pack.h"
+#include "raylib.h"
+
+#define ASSET_LOADER_MAX 32
+#define ASSET_LOADER_THREADS 2
+
+enum AssetStatus
+{
+    ASSET_PENDING,
+    ASSET_DECODED,
+    ASSET_FAILED,
+    ASSET_DONE
+};
+
+typedef struct AssetRequest
+{
+    const char *name;
+    uint32_t type;
+    // Filled in by a worker before the status turns ASSET_DECODED
+    Image image;
+    Wave wave;
+    bool owned;
+    Texture2D *texture;
+    Sound *sound;
+    atomic_int status;
+} AssetRequest;
+
+// Background asset loading. Workers turn requests into CPU-side images and
+// waves, either pointing into the mapped asset pack or decoded from the loose
+// files; the main thread then creates the GL textures and audio buffers a few
+// per frame, in request order, and writes them to the destinations given.
+typedef struct AssetLoader
+{
+    AssetPack pack;
+    const char *resourceDir;
+    AssetRequest requests[ASSET_LOADER_MAX];
+    int count;
+    int uploaded;
+    atomic_int next;
+    pthread_t threads[ASSET_LOADER_THREADS];
+    int threadCount;
+} AssetLoader;
+
+void initAssetLoader(AssetLoader *loader, const char *packPath, const char *resourceDir);
+// Requests are queued before startAssetLoader; destinations stay zeroed until
+// their asset is uploaded
+void requestTexture(AssetLoader *loader, const char *name, Texture2D *texture);
+void requestSound(AssetLoader *loader, const char *name, Sound *sound);
+void startAssetLoader(AssetLoader *loader);
+// Main thread only. Uploads up to maxUploads decoded assets and returns how
+// many it uploaded.
+int uploadLoadedAssets(AssetLoader *loader, int maxUploads);
+// True once the asset written to destination has been uploaded or given up on
+bool isAssetReady(const AssetLoader *loader, const void *destination);
+float assetLoaderProgress(const AssetLoader *loader);
+void unloadAssetLoader(AssetLoader *loader);
+
+#endif
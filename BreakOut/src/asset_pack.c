@@ -0,0 +1,195 @@
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200112L
+#endif
+
+#include "asset_pack.h"
+#include "byte_stream.h"
+#include "memtrack.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static const unsigned char packMagic[4] = {'B', 'R', 'P', 'K'};
+
+#define HEADER_SIZE 8
+#define ENTRY_SIZE (ASSET_NAME_MAX + 4 + 16 + 8 + 8)
+
+static uint64_t alignUp(uint64_t value)
+{
+    return (value + ASSET_PACK_ALIGN - 1) & ~(uint64_t)(ASSET_PACK_ALIGN - 1);
+}
+
+bool writeAssetPack(const char *fileName, const AssetEntry *entries, const void *const *data, int count)
+{
+    if (count < 0 || count > ASSET_PACK_MAX_ENTRIES)
+        return false;
+
+    size_t tocSize = HEADER_SIZE + (size_t)count * ENTRY_SIZE;
+    unsigned char *toc = memAlloc(tocSize, MEM_ASSETS);
+    if (!toc)
+        return false;
+    ByteStream out = {toc, 0, tocSize, 0, false};
+    putBytes(&out, packMagic, 4);
+    putU16(&out, ASSET_PACK_VERSION);
+    putU16(&out, (uint32_t)count);
+    uint64_t offset = alignUp(tocSize);
+    for (int i = 0; i < count; i++)
+    {
+        const AssetEntry *entry = &entries[i];
+        putBytes(&out, entry->name, ASSET_NAME_MAX);
+        putU32(&out, entry->type);
+        for (int p = 0; p < 4; p++)
+            putU32(&out, entry->params[p]);
+        putU64(&out, offset);
+        putU64(&out, entry->size);
+        offset = alignUp(offset + entry->size);
+    }
+
+    FILE *file = fopen(fileName, "wb");
+    bool ok = file && !out.failed && fwrite(toc, 1, tocSize, file) == tocSize;
+    uint64_t position = tocSize;
+    static const unsigned char padding[ASSET_PACK_ALIGN];
+    for (int i = 0; ok && i < count; i++)
+    {
+        size_t pad = (size_t)(alignUp(position) - position);
+        ok = fwrite(padding, 1, pad, file) == pad && fwrite(data[i], 1, entries[i].size, file) == entries[i].size;
+        position += pad + entries[i].size;
+    }
+    if (file)
+        ok = fclose(file) == 0 && ok;
+    memFree(toc);
+    return ok;
+}
+
+static bool readWholeFile(AssetPack *pack, const char *fileName)
+{
+    FILE *file = fopen(fileName, "rb");
+    if (!file)
+        return false;
+    long size = -1;
+    if (fseek(file, 0, SEEK_END) == 0)
+        size = ftell(file);
+    unsigned char *data = size > 0 && fseek(file, 0, SEEK_SET) == 0 ? memAlloc((size_t)size, MEM_ASSETS) : 0;
+    bool ok = data && fread(data, 1, (size_t)size, file) == (size_t)size;
+    fclose(file);
+    if (!ok)
+    {
+        memFree(data);
+        return false;
+    }
+    pack->base = data;
+    pack->size = (size_t)size;
+    pack->mapped = false;
+    return true;
+}
+
+#if !defined(_WIN32)
+static bool mapFile(AssetPack *pack, const char *fileName)
+{
+    int fd = open(fileName, O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat info;
+    void *data = MAP_FAILED;
+    if (fstat(fd, &info) == 0 && info.st_size > 0)
+        data = mmap(0, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    // The mapping keeps the file alive on its own
+    close(fd);
+    if (data == MAP_FAILED)
+        return false;
+    pack->base = data;
+    pack->size = (size_t)info.st_size;
+    pack->mapped = true;
+    return true;
+}
+#endif
+
+static void releaseFile(AssetPack *pack)
+{
+#if !defined(_WIN32)
+    if (pack->mapped)
+    {
+        munmap((void *)pack->base, pack->size);
+        return;
+    }
+#endif
+    memFree((void *)pack->base);
+}
+
+bool openAssetPack(AssetPack *pack, const char *fileName)
+{
+    memset(pack, 0, sizeof(*pack));
+#if !defined(_WIN32)
+    if (!mapFile(pack, fileName) && !readWholeFile(pack, fileName))
+        return false;
+#else
+    if (!readWholeFile(pack, fileName))
+        return false;
+#endif
+
+    ByteStream in = {0, pack->base, pack->size, 0, false};
+    unsigned char magic[4];
+    getBytes(&in, magic, 4);
+    uint32_t version = getU16(&in);
+    int count = (int)getU16(&in);
+    AssetEntry *entries = 0;
+    bool ok = !in.failed && memcmp(magic, packMagic, 4) == 0 && version == ASSET_PACK_VERSION && count <= ASSET_PACK_MAX_ENTRIES;
+    if (ok && count > 0)
+    {
+        entries = memAlloc(sizeof(AssetEntry) * count, MEM_ASSETS);
+        ok = entries != 0;
+    }
+    for (int i = 0; ok && i < count; i++)
+    {
+        AssetEntry *entry = &entries[i];
+        getBytes(&in, entry->name, ASSET_NAME_MAX);
+        entry->name[ASSET_NAME_MAX - 1] = '\0';
+        entry->type = getU32(&in);
+        for (int p = 0; p < 4; p++)
+            entry->params[p] = getU32(&in);
+        entry->offset = getU64(&in);
+        entry->size = getU64(&in);
+        ok = !in.failed && entry->offset <= pack->size && entry->size <= pack->size - entry->offset;
+    }
+    if (!ok)
+    {
+        memFree(entries);
+        releaseFile(pack);
+        memset(pack, 0, sizeof(*pack));
+        return false;
+    }
+    pack->entries = entries;
+    pack->count = count;
+    return true;
+}
+
+void closeAssetPack(AssetPack *pack)
+{
+    if (pack->base)
+        releaseFile(pack);
+    memFree(pack->entries);
+    memset(pack, 0, sizeof(*pack));
+}
+
+const AssetEntry *findAsset(const AssetPack *pack, const char *name, uint32_t type)
+{
+    for (int i = 0; i < pack->count; i++)
+    {
+        if (pack->entries[i].type == type && strcmp(pack->entries[i].name, name) == 0)
+            return &pack->entries[i];
+    }
+    return 0;
+}
+
+const void *assetData(const AssetPack *pack, const AssetEntry *entry)
+{
+    return pack->base + entry->offset;
+}
@@ -0,0 +1,53 @@
+#ifndef BREAKOUT_ASSET_PACK_H
+#define BREAKOUT_ASSET_PACK_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define ASSET_PACK_VERSION 1
+// Blobs start on this boundary from the start of the file, so they are just
+// as aligned in a page-aligned mapping
+#define ASSET_PACK_ALIGN 64
+#define ASSET_NAME_MAX 48
+#define ASSET_PACK_MAX_ENTRIES 256
+
+enum AssetType
+{
+    ASSET_IMAGE = 1,
+    ASSET_WAVE
+};
+
+// params hold width, height, mipmaps, pixel format for images and frame
+// count, sample rate, sample size, channels for waves, in the field order of
+// raylib's Image and Wave so the loader can fill them in directly
+typedef struct AssetEntry
+{
+    char name[ASSET_NAME_MAX];
+    uint32_t type;
+    uint32_t params[4];
+    uint64_t offset;
+    uint64_t size;
+} AssetEntry;
+
+// A pack opened for reading. The file is memory-mapped where the platform
+// allows and read into one allocation otherwise; either way asset data is
+// used in place until the pack is closed.
+typedef struct AssetPack
+{
+    const unsigned char *base;
+    size_t size;
+    AssetEntry *entries;
+    int count;
+    bool mapped;
+} AssetPack;
+
+// Layout: magic, version, entry count, then the table of contents and the
+// aligned blobs. Offsets in entries are ignored and filled in on write.
+bool writeAssetPack(const char *fileName, const AssetEntry *entries, const void *const *data, int count);
+bool openAssetPack(AssetPack *pack, const char *fileName);
+void closeAssetPack(AssetPack *pack);
+const AssetEntry *findAsset(const AssetPack *pack, const char *name, uint32_t type);
+const void *assetData(const AssetPack *pack, const AssetEntry *entry);
+
+#endif
@@ -0,0 +1,47 @@
+#include "bot.h"
+
+#define BOT_PRESS_INTERVAL 8
+#define BOT_DEAD_ZONE 6
+
+GameInput botInput(const GameState *game, unsigned int tick)
+{
+    GameInput input = {0, 0};
+    bool press = tick % BOT_PRESS_INTERVAL == 0;
+
+    if (game->state == PLAY)
+    {
+        // Follow the lowest ball on its way down, or ball 0 if none is
+        const BallSet *balls = &game->balls;
+        int follow = 0;
+        for (int i = 1; i < balls->count; i++)
+        {
+            if (balls->speedY[i] > 0 && (balls->speedY[follow] <= 0 || balls->y[i] > balls->y[follow]))
+                follow = i;
+        }
+        // Aim off-centre in the direction of travel so the ball doesn't settle
+        // into a single vertical bounce
+        float target = balls->x[follow] + (balls->speedX[follow] > 0 ? 1 : -1) * game->paddle.width / 4;
+        if (game->paddle.x < target - BOT_DEAD_ZONE)
+            input.down |= INPUT_RIGHT;
+        else if (game->paddle.x > target + BOT_DEAD_ZONE)
+            input.down |= INPUT_LEFT;
+        if (press && isBallServed(balls))
+            input.pressed |= INPUT_SPACE;
+    }
+    else if (game->state == PAUSED)
+    {
+        if (press)
+            input.pressed |= INPUT_SPACE;
+    }
+    else if (press)
+    {
+        // Every menu continues on the first entry
+        bool twoEntries = game->state == MENU || game->state == GAMEOVER || game->state == VICTORY;
+        if (twoEntries && game->menuIndex != 0)
+            input.pressed |= INPUT_DOWN;
+        else
+            input.pressed |= INPUT_ENTER;
+    }
+    input.down |= input.pressed;
+    return input;
+}
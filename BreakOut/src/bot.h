@@ -0,0 +1,11 @@
+#ifndef BREAKOUT_BOT_H
+#define BREAKOUT_BOT_H
+
+#include "sim.h"
+
+// Scripted player for headless runs. Walks the menus into PLAY, launches the
+// ball, tracks it with the paddle and keeps playing after victory or game over.
+// Presses are spaced out by tick so every one of them is a fresh edge.
+GameInput botInput(const GameState *game, unsigned int tick);
+
+#endif
@@ -1,74 +1,53 @@
 #include "raylib.h"
 #include "stdio.h"
+#include "time.h"
+#include "sim.h"
+#include "particles.h"
+#include "particle_render.h"
+#include "sprite_batch.h"
+#include "brick_layer.h"
+#include "chunk_stream.h"
+#include "atlas_frames.h"
+#include "profiler.h"
+#include "memtrack.h"
+#include "replay.h"
+#include "snapshot.h"
+#include "score_store.h"
+#include "asset_loader.h"
+#include "sound_manager.h"
+#include "text_cache.h"
 
 #define SIZEOF(A) (sizeof(A) / sizeof(A[0]))
-#define MAX_ROWS 4
-#define MAX_COLS 11
-#define MAX_PARTICLES 50
-#define BALL_SPEED 250
-#define PAD_SPEED 900
-#define SPRITE_SIZE 32
-#define BRICK_TIER 5
-#define BRICK_WIDTH 64
-#define BRICK_HEIGHT 32
-#define MAX_EMITTERS 3
-#define PADDLE_TOTAL 4
-
-typedef struct Ball
+// Frames of history kept for rewinding, five seconds at 60 FPS
+#define REWIND_FRAMES 300
+#define LEADERBOARD_SIZE 5
+// Baked by pack_assets next to the executable; the loose files are only used
+// when it is missing
+#define ASSET_PACK_FILE "breakout.pak"
+#define RESOURCE_DIR "BreakOut/resources/"
+// Texture and sound creations per frame while assets stream in
+#define ASSET_UPLOADS_PER_FRAME 2
+// Voices mixed at once across all effects
+#define SOUND_MIX_LIMIT 8
+// Screens without animation are only redrawn when something changes; in
+// between the loop sleeps this long, then polls input and audio again
+#define IDLE_POLL_INTERVAL (1.0 / 30.0)
+// Redraw a static screen at least this often, in case the window contents
+// were lost while it was covered or minimised
+#define STATIC_REDRAW_INTERVAL 1.0
+// Room for every particle plus the rest of the PLAY screen
+#define SPRITE_BATCH_CAPACITY (PARTICLE_CAPACITY + 2048)
+
+// Sprite batch layers, drawn bottom to top
+enum DrawLayer
 {
-    float x, y;
-    float speedX, speedY;
-    float radius;
-    Rectangle srcRect;
-} Ball;
-
-typedef struct Paddle
-{
-    float x, y;
-    float speed;
-    float width, height;
-    Rectangle collisionRect;
-    Rectangle srcRect;
-} Paddle;
-
-typedef struct Brick
-{
-    float x, y;
-    float width, height;
-    Rectangle collisionRect;
-    Rectangle srcRect;
-    int health;
-    int tier;
-    bool broken;
-} Brick;
-
-typedef struct Particle
-{
-    Vector2 position;
-    Color color;
-    float alpha;
-    float radius;
-    bool active;
-} Particle;
-
-typedef struct ParticleSystem
-{
-    Particle particles[MAX_PARTICLES];
-    Rectangle area;
-    Color color;
-    float radius;
-    float gravity;
-    float fade;
-} ParticleSystem;
-
-typedef struct Emitter
-{
-    ParticleSystem particleSys;
-    bool active;
-    float fade;
-    float size;
-    float gravity;
-} Emitter;
+    LAYER_BRICKS,
+    LAYER_PARTICLES,
+    LAYER_BACKDROP,
+    LAYER_GUIDES,
+    LAYER_SPRITES,
+    LAYER_HUD
+};
 
 typedef struct Button
 {
@@ -77,732 +56,486 @@ typedef struct Button
     bool active;
 } Button;
 
-typedef struct Setting
-{
-    int paddle;
-    int difficulty;
-} Setting;
-
-typedef struct ScoreBoard
-{
-    const char **scoreList;
-    const char *fileData;
-    int scoreData[10];
-    int storage;
-} ScoreBoard;
-
-enum State
-{
-    MENU,
-    SETTING,
-    PLAY,
-    GAMEOVER,
-    VICTORY,
-    SCOREBOARD,
-    PAUSED
-};
-
-void initBricks(Brick bricks[MAX_ROWS][MAX_COLS], int level);
-void initEmitter(Emitter *emitter, Rectangle area, Color color);
-void initParticleSystem(ParticleSystem *particleSystem);
-bool updateBall(Ball *ball);
-void resetBall(Ball *ball, float x, float y);
-void paddleControl(Paddle *paddle);
-bool paddleCollision(Ball *ball, Paddle *paddle);
-bool brickCollisions(Ball *ball, Brick bricks[MAX_ROWS][MAX_COLS], int *score, Emitter *emitter);
-void drawBricks(Brick bricks[MAX_ROWS][MAX_COLS], int rows, int cols, Texture2D spriteSheet, Rectangle srcRect);
-void drawParticleSystem(ParticleSystem particleSys);
-void updateParticleSystem(Emitter *emitter);
-void drawHearts(Texture2D spriteSheet, Rectangle srcRect, float x, float y, int lives);
-bool switchButtons(Button buttons[], int size, Color activeColor, Color normalColor);
-void drawButtons(Button buttons[], int total, int fontSize);
-void loadScoreData(ScoreBoard *scoreboard, char *fileName);
-void appendHighscore(ScoreBoard *scoreboard, int score);
-void saveScoreData(ScoreBoard *scoreboard, char *filename);
+void batchBalls(SpriteBatch *batch, Texture2D spriteSheet, const SpriteFrame *frame, const BallSet *balls, float alpha);
+void batchHearts(SpriteBatch *batch, Texture2D spriteSheet, const SpriteAtlas *atlas, float x, float y, int lives);
+void updateButtons(Button buttons[], int size, int activeIndex, Color activeColor, Color normalColor);
+void drawButtons(TextCache *text, Button buttons[], int total, int fontSize);
+GameInput readInput(void);
 Rectangle getRect(float x, float y, int width, int height);
 
 void debugPrint(int val, int x, int y);
 
-int main(void)
+int main(int argc, char **argv)
 {
     const int screenWidth = 900;
     const int screenHeight = 550;
-    char *scoreFileName = "score_board.txt";
+    const char *scoreBasePath = "scores";
+    const char *saveFileName = "savegame.bin";
+    int tickRate = SIM_TICK_RATE;
+    int targetFps = 60;
+    const char *profileCsv = 0;
+    const char *recordFile = 0;
+    const char *replayFile = 0;
+    for (int i = 1; i + 1 < argc; i++)
+    {
+        if (TextIsEqual(argv[i], "--tick-rate"))
+            tickRate = TextToInteger(argv[++i]);
+        else if (TextIsEqual(argv[i], "--fps"))
+            targetFps = TextToInteger(argv[++i]);
+        else if (TextIsEqual(argv[i], "--profile-csv"))
+            profileCsv = argv[++i];
+        else if (TextIsEqual(argv[i], "--record"))
+            recordFile = argv[++i];
+        else if (TextIsEqual(argv[i], "--replay"))
+            replayFile = argv[++i];
+    }
+    uint64_t seed = (uint64_t)time(NULL);
+    Replay playback = {0};
+    if (replayFile)
+    {
+        if (loadReplay(&playback, replayFile))
+        {
+            seed = playback.seed;
+            tickRate = playback.tickRate;
+        }
+        else
+        {
+            printf("Could not load replay %s\n", replayFile);
+            replayFile = 0;
+        }
+    }
+    Replay recording;
+    profilerInit(profileCsv);
 
     InitWindow(screenWidth, screenHeight, "Break Out");
     InitAudioDevice();
 
-    // Loading Sprites
-    Texture2D spriteSheet = LoadTexture("BreakOut/resources/sprites/breakOutAssets.png");
-    const Rectangle srcRectPaddle = {255, spriteSheet.height - SPRITE_SIZE * 1, SPRITE_SIZE * 3, SPRITE_SIZE};
-    const Rectangle srcRectBrick = {spriteSheet.width - BRICK_WIDTH * BRICK_TIER, 0, BRICK_WIDTH, BRICK_HEIGHT};
-    const Rectangle srcRectHeart = {704, 352, SPRITE_SIZE, SPRITE_SIZE};
-
-    // Loading SFX
-    Sound fxBounce = LoadSound("BreakOut/resources/audio/buttonFx.wav");
-    Sound fxHit = LoadSound("BreakOut/resources/audio/hitFx.wav");
-    Sound fxFall = LoadSound("BreakOut/resources/audio/fallFx.wav");
-    Sound fxSelect = LoadSound("BreakOut/resources/audio/menuFx.wav");
-    Sound fxImpact = LoadSound("BreakOut/resources/audio/impactFx.wav");
-    Sound fxPause = LoadSound("BreakOut/resources/audio/pauseFx.wav");
-    Sound fxDisable = LoadSound("BreakOut/resources/audio/disableFx.wav");
-
-    int level = 4;
-    int lives = 3;
-    int score = 0;
-    ScoreBoard scoreboard;
-    scoreboard.storage = 5;
-    for (int i = 0; i < scoreboard.storage; i++)
-        scoreboard.scoreData[i] = 0;
-    loadScoreData(&scoreboard, scoreFileName);
+    // Assets stream in from worker threads. The menu only draws text so it
+    // runs from the first frame; screens that draw sprites wait in LOADING,
+    // and a sound that has not arrived yet is skipped.
+    AssetLoader loader;
+    initAssetLoader(&loader, TextFormat("%s%s", GetApplicationDirectory(), ASSET_PACK_FILE), RESOURCE_DIR);
+    // The baked atlas only exists in the pack; loose files use the full sheet
+    const SpriteAtlas *atlas = findAsset(&loader.pack, packedAtlas.asset, ASSET_IMAGE) ? &packedAtlas : &sheetAtlas;
+    Texture2D spriteSheet;
+    requestTexture(&loader, atlas->asset, &spriteSheet);
+    // Effects with their polyphony and priority; gameplay sounds that come
+    // in bursts get more voices, rare cues win when the mixer is full
+    SoundManager sounds;
+    initSoundManager(&sounds, SOUND_MIX_LIMIT);
+    int fxBounce = addSoundEffect(&sounds, 4, 1);
+    int fxHit = addSoundEffect(&sounds, 4, 2);
+    int fxFall = addSoundEffect(&sounds, 1, 3);
+    int fxSelect = addSoundEffect(&sounds, 2, 3);
+    int fxImpact = addSoundEffect(&sounds, 3, 1);
+    int fxPause = addSoundEffect(&sounds, 1, 3);
+    int fxDisable = addSoundEffect(&sounds, 1, 3);
+    requestSound(&loader, "audio/buttonFx.wav", soundEffectSource(&sounds, fxBounce));
+    requestSound(&loader, "audio/hitFx.wav", soundEffectSource(&sounds, fxHit));
+    requestSound(&loader, "audio/fallFx.wav", soundEffectSource(&sounds, fxFall));
+    requestSound(&loader, "audio/menuFx.wav", soundEffectSource(&sounds, fxSelect));
+    requestSound(&loader, "audio/impactFx.wav", soundEffectSource(&sounds, fxImpact));
+    requestSound(&loader, "audio/pauseFx.wav", soundEffectSource(&sounds, fxPause));
+    requestSound(&loader, "audio/disableFx.wav", soundEffectSource(&sounds, fxDisable));
+    startAssetLoader(&loader);
+
+    bool spritesReady = false;
+    enum State resumeState = MENU;
+
+    ScoreStore scores;
+    if (!openScoreStore(&scores, scoreBasePath))
+        printf("Could not open the score store %s\n", scoreBasePath);
+    ScoreEntry leaderboard[LEADERBOARD_SIZE];
+    int leaderboardCount = topScores(&scores, leaderboard, LEADERBOARD_SIZE);
+    // Constant strings are laid out once; numbers only when they change
+    TextCache text;
+    initTextCache(&text);
+    IntLabel levelLabel;
+    initIntLabel(&levelLabel, "Level: %d", 150);
+    IntLabel scoreLabel;
+    initIntLabel(&scoreLabel, "Score: %d", 40);
+    char rankFormats[LEADERBOARD_SIZE][16];
+    IntLabel rankLabels[LEADERBOARD_SIZE];
+    for (int i = 0; i < LEADERBOARD_SIZE; i++)
+    {
+        snprintf(rankFormats[i], sizeof(rankFormats[i]), "%d.%%4d", i + 1);
+        initIntLabel(&rankLabels[i], rankFormats[i], 40);
+    }
     Button menuButtons[] = {
         (Button){WHITE, "Start", true},
         (Button){WHITE, "Leaderboard", false}};
 
-    Emitter *emitters[MAX_EMITTERS];
-    for (int e = 0; e < MAX_EMITTERS; e++)
+    ParticleSystem particles;
+    initParticleSystem(&particles, PARTICLE_CAPACITY, 5.0f, 0.09f, 0.05f, seed);
+    SpriteBatch sprites;
+    initSpriteBatch(&sprites, SPRITE_BATCH_CAPACITY);
+    Color hitColors[] = {RED, DARKBLUE, DARKGREEN, BROWN, YELLOW, PURPLE};
+
+    GameState game;
+    initGameState(&game, screenWidth, screenHeight, seed);
+    // Endless rows are made ahead on a worker; the run is the same without it
+    ChunkStream chunkStream;
+    startChunkStream(&chunkStream);
+    game.chunkStream = &chunkStream;
+    const Paddle *paddle = &game.paddle;
+    FixedStep clock;
+    initFixedStep(&clock, tickRate);
+    // Recorded at the rate the clock settled on, not the one asked for
+    initReplay(&recording, seed, clock.tickRate, screenWidth, screenHeight);
+    if (replayFile)
+        clock.playback = &playback;
+    if (recordFile)
+        clock.recording = &recording;
+    // Rewinding and resuming would jump the state outside the recorded ticks
+    bool canRewind = !replayFile && !recordFile;
+    RewindBuffer rewind;
+    initRewindBuffer(&rewind, REWIND_FRAMES, REWIND_FRAMES * 512);
+    if (canRewind && loadSnapshot(saveFileName, &game, &particles))
     {
-        emitters[e] = (Emitter *)MemAlloc(sizeof(Emitter));
-        emitters[e]->active = false;
-        emitters[e]->fade = 0.05f;
-        emitters[e]->gravity = 0.09f;
-        emitters[e]->size = 5.0f;
+        if (game.state == PLAY)
+            game.state = PAUSED;
+        remove(saveFileName);
     }
-
-    Ball ball;
-    ball.x = screenWidth / 2;
-    ball.y = screenHeight - 150;
-    ball.speedX = 0;
-    ball.speedY = 0;
-    ball.radius = SPRITE_SIZE / 2;
-    ball.srcRect = (Rectangle){383, spriteSheet.height - SPRITE_SIZE, SPRITE_SIZE, SPRITE_SIZE};
-
-    Paddle paddle;
-    paddle.x = screenWidth / 2;
-    paddle.y = screenHeight - 80;
-    paddle.speed = PAD_SPEED;
-    paddle.width = SPRITE_SIZE * 3;
-    paddle.height = SPRITE_SIZE;
-    paddle.srcRect = srcRectPaddle;
-
-    Brick bricks[MAX_ROWS][MAX_COLS] = {0};
-    initBricks(bricks, level);
-
-    enum State gameState = MENU;
-    Setting gameSetting = {0, 0};
-    SetTargetFPS(60);
+    BrickLayer brickLayer = {0};
+
+    SetTargetFPS(targetFps);
+    // Frame time is measured here rather than taken from GetFrameTime, which
+    // only advances in EndDrawing and so stalls while static screens idle
+    double lastTime = GetTime();
+    double lastDraw = 0.0;
+    bool dirty = true;
+    enum State drawnState = game.state;
     // Main game loop
     while (!WindowShouldClose())
     {
-        // Debug Code
-        if (IsKeyPressed(KEY_R))
-            initBricks(bricks, level);
-        // Menu Screen
-        if (gameState == MENU)
+        double now = GetTime();
+        float frameTime = (float)(now - lastTime);
+        lastTime = now;
+
+        uploadLoadedAssets(&loader, ASSET_UPLOADS_PER_FRAME);
+        if (!spritesReady && isAssetReady(&loader, &spriteSheet))
         {
-            menuButtons[0].name = "Start";
-            menuButtons[1].name = "Leaderboard";
-            if (switchButtons(menuButtons, SIZEOF(menuButtons), ORANGE, WHITE))
-                PlaySound(fxSelect);
-            // Switch to Setting Screen
-            if (IsKeyPressed(KEY_ENTER))
-            {
-                PlaySound(fxSelect);
-                if (menuButtons[0].active)
-                    gameState = SETTING;
-                else
-                    gameState = SCOREBOARD;
-            }
+            int layerRows = ENDLESS_FIELD_ROWS > MAX_ROWS ? ENDLESS_FIELD_ROWS : MAX_ROWS;
+            initBrickLayer(&brickLayer, screenWidth, layerRows * BRICK_HEIGHT, spriteSheet, atlas);
+            spritesReady = true;
+            if (game.state == LOADING)
+                game.state = resumeState;
         }
-        // Paddle Select State
-        else if (gameState == SETTING)
-        {
-            if (IsKeyPressed(KEY_RIGHT))
-            {
-                if (gameSetting.paddle < PADDLE_TOTAL - 1)
-                {
-                    gameSetting.paddle++;
-                    PlaySound(fxSelect);
-                }
-                else
-                    PlaySound(fxDisable);
-            }
 
-            if (IsKeyPressed(KEY_LEFT))
-            {
-                if (gameSetting.paddle > 0)
-                {
-                    gameSetting.paddle--;
-                    PlaySound(fxSelect);
-                }
-                else
-                {
-                    PlaySound(fxDisable);
-                }
-            }
+        PROFILE_BEGIN(PHASE_INPUT);
+        // Debug Code, off while recording or replaying since it bypasses the tick input
+        if (IsKeyPressed(KEY_R) && !clock.playback && !clock.recording && !game.endless)
+            initBricks(&game.bricks, game.level, game.screenWidth, &game.levelRng);
+        if (IsKeyPressed(KEY_F3))
+        {
+            profilerToggleOverlay();
+            dirty = true;
+        }
+        if (IsKeyPressed(KEY_F4))
+        {
+            memtrackToggleOverlay();
+            dirty = true;
+        }
+        GameInput input = readInput();
+        PROFILE_END(PHASE_INPUT);
 
-            paddle.srcRect = (Rectangle){srcRectPaddle.x, srcRectPaddle.y - paddle.height * gameSetting.paddle, paddle.width, paddle.height};
-            if (IsKeyPressed(KEY_ENTER))
-            {
-                PlaySound(fxSelect);
-                initBricks(bricks, level);
-                resetBall(&ball, paddle.x, paddle.y - paddle.height - ball.radius);
-                gameState = PLAY;
-            }
+        PROFILE_BEGIN(PHASE_PHYSICS);
+        enum State stepState = game.state;
+        // Hold BACKSPACE to step back through the last few seconds of play
+        if (canRewind && IsKeyDown(KEY_BACKSPACE) && (game.state == PLAY || game.state == PAUSED))
+        {
+            if (popRewind(&rewind, &game))
+                game.state = PLAY;
+            clock.accumulator = 0;
+            clock.events = 0;
+            clock.hitCount = 0;
         }
-        // Gameover state
-        else if (gameState == GAMEOVER)
+        // The simulation is held, not stepped, while loading, so recorded
+        // ticks never depend on how fast the assets arrived
+        else if (game.state == LOADING)
         {
-            menuButtons[0].name = "Play Again";
-            menuButtons[1].name = "Main Menu";
-            if (switchButtons(menuButtons, SIZEOF(menuButtons), GOLD, WHITE))
-                PlaySound(fxSelect);
-            if (IsKeyPressed(KEY_ENTER))
-            {
-                PlaySound(fxSelect);
-                ;
-                if (menuButtons[1].active)
-                    gameState = MENU;
-                else
-                {
-                    lives = 3;
-                    score = 0;
-                    level = 1;
-                    initBricks(bricks, level);
-                    resetBall(&ball, paddle.x, paddle.y - paddle.height - ball.radius);
-                    gameState = PLAY;
-                }
-            }
+            clock.events = 0;
+            clock.hitCount = 0;
         }
-        // Victory State
-        else if (gameState == VICTORY)
+        else
         {
-            menuButtons[0].name = "Next Level";
-            menuButtons[1].name = "Leaderboards";
-
-            if (switchButtons(menuButtons, SIZEOF(menuButtons), VIOLET, BLACK))
-                PlaySound(fxSelect);
-            if (IsKeyPressed(KEY_ENTER))
-            {
-                PlaySound(fxSelect);
-                if (menuButtons[1].active)
-                {
-                    gameState = SCOREBOARD;
-                }
-                else
-                {
-
-                    initBricks(bricks, level);
-                    resetBall(&ball, paddle.x, paddle.y - paddle.height - ball.radius);
-                    gameState = PLAY;
-                }
-            }
+            int ticks = advanceFixedStep(&clock, &game, input, frameTime);
+            if (game.state == PLAY && ticks > 0)
+                pushRewind(&rewind, &game);
+            else if (game.state != PLAY && game.state != PAUSED)
+                clearRewindBuffer(&rewind);
         }
-        else if (gameState == SCOREBOARD)
+        if (!spritesReady && (game.state == SETTING || game.state == PLAY || game.state == PAUSED))
         {
-            if (IsKeyPressed(KEY_ENTER))
-            {
-                PlaySound(fxSelect);
-                gameState = MENU;
-            }
+            resumeState = game.state;
+            game.state = LOADING;
         }
-        // Play State
-        else if (gameState == PLAY)
+        PROFILE_END(PHASE_PHYSICS);
+
+        if (clock.events & EVENT_SELECT)
+            triggerSound(&sounds, fxSelect, 1);
+        if (clock.events & EVENT_DISABLE)
+            triggerSound(&sounds, fxDisable, 1);
+        if (clock.events & EVENT_BOUNCE)
+            triggerSound(&sounds, fxBounce, 1);
+        if (clock.events & EVENT_IMPACT)
+            triggerSound(&sounds, fxImpact, 1);
+        if (clock.events & EVENT_HIT)
+            triggerSound(&sounds, fxHit, 1);
+        if (clock.events & EVENT_FALL)
+            triggerSound(&sounds, fxFall, 1);
+        if (clock.events & EVENT_PAUSE)
+            triggerSound(&sounds, fxPause, 1);
+        if (clock.events & EVENT_MULTIBALL)
+            triggerSound(&sounds, fxSelect, 1);
+        flushSounds(&sounds);
+        // Replays only re-run games that were already scored. An endless run
+        // has no victory and is scored when it ends.
+        bool runEnded = game.endless && game.state == GAMEOVER && stepState != GAMEOVER;
+        if ((clock.events & EVENT_VICTORY || runEnded) && !replayFile)
         {
-            if (IsKeyPressed(KEY_SPACE))
-            {
-
-                if (ball.speedX == 0 && ball.speedY == 0)
-                {
-                    PlaySound(fxSelect);
-                    ball.speedX = BALL_SPEED;
-                    ball.speedY = BALL_SPEED;
-                }
-                else
-                {
-                    PlaySound(fxPause);
-                    gameState = PAUSED;
-                }
-            }
-
-            if (ball.speedX == 0 && ball.speedY == 0)
-                resetBall(&ball, paddle.x, paddle.y - paddle.height - ball.radius);
-            // Paddle Control
-            paddleControl(&paddle);
-            // paddleCollision(&ball, &paddle);
+            if (!recordScore(&scores, (ScoreEntry){game.score, game.level, game.setting.paddle, (int64_t)time(NULL)}))
+                printf("Could not record score %d\n", game.score);
+            leaderboardCount = topScores(&scores, leaderboard, LEADERBOARD_SIZE);
+        }
 
-            if (paddleCollision(&ball, &paddle))
-                PlaySound(fxBounce);
+        PROFILE_BEGIN(PHASE_PARTICLES);
+        for (int h = 0; h < clock.hitCount; h++)
+        {
+            BrickHit hit = clock.hits[h];
+            Color color = hitColors[hit.colorIndex];
+            emitParticles(&particles, hit.x, hit.y, hit.width, hit.height, (ParticleColor){color.r, color.g, color.b, color.a}, PARTICLES_PER_BURST);
+        }
+        if (game.state == PLAY)
+            updateParticleSystem(&particles, frameTime);
+        PROFILE_END(PHASE_PARTICLES);
 
-            // Get available emitter
-            Emitter *freeEmitter;
-            for (int e = MAX_EMITTERS - 1; e > 0; e--)
-            {
-                freeEmitter = emitters[0];
-                if (!emitters[e]->active)
-                {
-                    emitters[e]->active = true;
-                    freeEmitter = emitters[e];
-                    e = 0;
-                }
-            }
-            if (brickCollisions(&ball, bricks, &score, freeEmitter))
-                PlaySound(fxImpact);
-            if (updateBall(&ball))
-                PlaySound(fxHit);
-            for (int e = 0; e < MAX_EMITTERS; e++)
-            {
-                if (!emitters[e]->active)
-                    continue;
-                updateParticleSystem(emitters[e]);
-            }
-            if (ball.y >= screenHeight + SPRITE_SIZE)
-            {
-                PlaySound(fxFall);
-                lives--;
-                if (lives <= 0)
-                    gameState = GAMEOVER;
-                else
-                    resetBall(&ball, paddle.x, paddle.y - paddle.height - ball.radius);
-            }
-            bool victory = true;
-            for (int i = 0; i < MAX_ROWS; i++)
-            {
-                for (int j = 0; j < MAX_COLS; j++)
-                {
-                    if (!(bricks[i][j].broken))
-                        victory = false;
-                }
-            }
-            if (victory)
-            {
-                gameState = VICTORY;
-                level++;
-                score += (level * 100);
-                appendHighscore(&scoreboard, score);
-            }
+        if (game.state == MENU)
+        {
+            menuButtons[0].name = "Start";
+            menuButtons[1].name = "Leaderboard";
+            updateButtons(menuButtons, SIZEOF(menuButtons), game.menuIndex, ORANGE, WHITE);
         }
-        else if (gameState == PAUSED)
+        else if (game.state == GAMEOVER)
         {
-            if (IsKeyPressed(KEY_SPACE))
-            {
-                PlaySound(fxPause);
-                gameState = PLAY;
-            }
+            menuButtons[0].name = "Play Again";
+            menuButtons[1].name = "Main Menu";
+            updateButtons(menuButtons, SIZEOF(menuButtons), game.menuIndex, GOLD, WHITE);
         }
+        else if (game.state == VICTORY)
+        {
+            menuButtons[0].name = "Next Level";
+            menuButtons[1].name = "Leaderboards";
+            updateButtons(menuButtons, SIZEOF(menuButtons), game.menuIndex, VIOLET, BLACK);
+        }
+        const SpriteFrame *skin = &atlas->paddle[game.setting.paddle];
+        // Blend the last two physics states for rendering
+        float alpha = fixedStepAlpha(&clock);
+        float paddleX = game.prevPaddleX + (paddle->x - game.prevPaddleX) * alpha;
+
+        // Menus, the leaderboard and the pause screen only change on input or
+        // a state change; otherwise skip the frame instead of presenting a
+        // copy of the last one
+        bool animated = game.state == PLAY || game.state == LOADING || profilerOverlayVisible() || memtrackOverlayVisible();
+        if (input.pressed || clock.events || game.state != drawnState)
+            dirty = true;
+        if (!animated && !dirty && now - lastDraw < STATIC_REDRAW_INTERVAL)
+        {
+            WaitTime(IDLE_POLL_INTERVAL);
+            PollInputEvents();
+            PROFILE_END_FRAME();
+            memtrackEndFrame();
+            continue;
+        }
+        dirty = false;
+        drawnState = game.state;
+        lastDraw = now;
+
+        PROFILE_BEGIN(PHASE_DRAW);
+        if (game.state == PLAY)
+            updateBrickLayer(&brickLayer, &game.bricks, &sprites);
 
         BeginDrawing();
 
-        if (gameState == MENU)
+        if (game.state == MENU)
         {
             ClearBackground(SKYBLUE);
-            DrawText("Break-it", screenWidth / 2 - MeasureText("Break-it", 200) / 2 - 3, 13, 200, DARKGRAY);
-            DrawText("Break-it", screenWidth / 2 - MeasureText("Break-it", 200) / 2, 10, 200, MAROON);
-            drawButtons(menuButtons, SIZEOF(menuButtons), 70);
+            drawCachedTextCentered(&text, "Break-it", screenWidth / 2 - 3, 13, 200, DARKGRAY);
+            drawCachedTextCentered(&text, "Break-it", screenWidth / 2, 10, 200, MAROON);
+            drawButtons(&text, menuButtons, SIZEOF(menuButtons), 70);
         }
-        else if (gameState == SETTING)
+        else if (game.state == SETTING)
         {
             ClearBackground(SKYBLUE);
-            DrawText("Select Paddle", screenWidth / 2 - MeasureText("Select Paddle", 80) / 2, 10, 80, MAROON);
-            DrawText("Press LEFT/RIGHT ARROW to change skin", screenWidth / 2 - MeasureText("Press LEFT/RIGHT ARROW to change skin", 30) / 2, screenHeight - 100, 30, DARKGRAY);
-            DrawText("Press ENTER to continue", screenWidth / 2 - MeasureText("Press ENTER to continue", 30) / 2, screenHeight - 50, 30, DARKGRAY);
-            DrawRectangle(screenWidth / 2 - paddle.width, screenHeight / 2 - paddle.height, paddle.width * 2, paddle.height * 3, DARKGRAY);
-            DrawTextureRec(spriteSheet, paddle.srcRect, (Vector2){screenWidth / 2 - paddle.width / 2, screenHeight / 2}, WHITE);
+            drawCachedTextCentered(&text, "Select Paddle", screenWidth / 2, 10, 80, MAROON);
+            drawCachedTextCentered(&text, game.setting.mode == MODE_ENDLESS ? "Mode: Endless" : "Mode: Classic", screenWidth / 2, screenHeight / 2 + 85, 40, MAROON);
+            drawCachedTextCentered(&text, "Press UP/DOWN ARROW to change mode", screenWidth / 2, screenHeight - 135, 30, DARKGRAY);
+            drawCachedTextCentered(&text, "Press LEFT/RIGHT ARROW to change skin", screenWidth / 2, screenHeight - 100, 30, DARKGRAY);
+            drawCachedTextCentered(&text, "Press ENTER to continue", screenWidth / 2, screenHeight - 50, 30, DARKGRAY);
+            DrawRectangle(screenWidth / 2 - paddle->width, screenHeight / 2 - paddle->height, paddle->width * 2, paddle->height * 3, DARKGRAY);
+            drawSpriteFrame(spriteSheet, skin, screenWidth / 2 - paddle->width / 2, screenHeight / 2, WHITE);
         }
-        else if (gameState == VICTORY)
+        else if (game.state == VICTORY)
         {
             ClearBackground(RAYWHITE);
-            DrawText("Level Clear!", screenWidth / 2 - MeasureText("Level Clear!", 100) / 2, 30, 100, MAGENTA);
-            drawButtons(menuButtons, SIZEOF(menuButtons), 70);
+            drawCachedTextCentered(&text, "Level Clear!", screenWidth / 2, 30, 100, MAGENTA);
+            drawButtons(&text, menuButtons, SIZEOF(menuButtons), 70);
         }
-        else if (gameState == PLAY)
+        else if (game.state == PLAY)
         {
             ClearBackground(SKYBLUE);
-            drawBricks(bricks, MAX_ROWS, MAX_COLS, spriteSheet, srcRectBrick);
-            for (int e = 0; e < MAX_EMITTERS; e++)
-            {
-                drawParticleSystem(emitters[e]->particleSys);
-            }
-            DrawText(TextFormat("Level: %d", level), screenWidth / 2 - MeasureText("Level: 8", 150) / 2, screenHeight / 2, 150, Fade(WHITE, 0.2));
-
-            DrawTextureRec(spriteSheet, ball.srcRect, (Vector2){ball.x - ball.radius, ball.y - ball.radius}, WHITE);
-            DrawTextureRec(spriteSheet, paddle.srcRect, (Vector2){paddle.x - paddle.width / 2, paddle.y - paddle.height / 2}, WHITE);
-
-            DrawText(TextFormat("Score: %d", score), 10, screenHeight - 50, 40, WHITE);
-            drawHearts(spriteSheet, srcRectHeart, screenWidth - srcRectHeart.width * 4, screenHeight - srcRectHeart.height - 20, lives);
+            batchBrickLayer(&brickLayer, &sprites, LAYER_BRICKS, game.bricks.top);
+            batchParticleSystem(&sprites, LAYER_PARTICLES, &particles);
+            // Rows with bricks left cost a life when they cross this line
+            if (game.endless)
+                batchRectangle(&sprites, LAYER_GUIDES, (Rectangle){0, game.bricks.rows * BRICK_HEIGHT, screenWidth, 2}, Fade(WHITE, 0.3f));
+            batchIntLabel(&sprites, LAYER_BACKDROP, &text, &levelLabel, game.level, screenWidth / 2 - cachedTextWidth(&text, "Level: 8", 150) / 2, screenHeight / 2, Fade(WHITE, 0.2));
+
+            batchBalls(&sprites, spriteSheet, &atlas->ball, &game.balls, alpha);
+            batchSpriteFrame(&sprites, LAYER_SPRITES, spriteSheet, skin, paddleX - paddle->width / 2, paddle->y - paddle->height / 2, WHITE);
+            batchHearts(&sprites, spriteSheet, atlas, screenWidth - SPRITE_SIZE * 4, screenHeight - SPRITE_SIZE - 20, game.lives);
+
+            batchIntLabel(&sprites, LAYER_HUD, &text, &scoreLabel, game.score, 10, screenHeight - 50, WHITE);
+            flushSpriteBatch(&sprites);
         }
-        else if (gameState == GAMEOVER)
+        else if (game.state == GAMEOVER)
         {
             ClearBackground(DARKGRAY);
-            DrawText("Game Over!", screenWidth / 2 - MeasureText("Game Over!", 150) / 2, 100, 150, RED);
-            drawButtons(menuButtons, SIZEOF(menuButtons), 70);
+            drawCachedTextCentered(&text, "Game Over!", screenWidth / 2, 100, 150, RED);
+            drawButtons(&text, menuButtons, SIZEOF(menuButtons), 70);
         }
-        else if (gameState == SCOREBOARD)
+        else if (game.state == SCOREBOARD)
         {
             ClearBackground(DARKGRAY);
-            DrawText("Leaderboard", screenWidth / 2 - MeasureText("Leaderboard", 70) / 2, 10, 70, BLUE);
-            for (int i = 0; i < scoreboard.storage; i++)
+            drawCachedTextCentered(&text, "Leaderboard", screenWidth / 2, 10, 70, BLUE);
+            for (int i = 0; i < LEADERBOARD_SIZE; i++)
             {
-                const char *scoreText = TextFormat("%d.%4d\n", i + 1, scoreboard.scoreData[i]);
-                DrawText(scoreText, screenWidth / 2 - MeasureText(scoreText, 40), (screenHeight / 2 - 100) + 50 * i, 40, WHITE);
+                // Right-aligned on the centre line
+                int score = i < leaderboardCount ? leaderboard[i].score : 0;
+                int width = intLabelWidth(&text, &rankLabels[i], score);
+                drawIntLabel(&text, &rankLabels[i], score, screenWidth / 2 - width, (screenHeight / 2 - 100) + 50 * i, WHITE);
             }
 
-            DrawText("Main Menu", 10, screenHeight - 80, 40, ORANGE);
+            drawCachedText(&text, "Main Menu", 10, screenHeight - 80, 40, ORANGE);
         }
-        else
+        else if (game.state == LOADING)
         {
-            DrawText("Paused II", screenWidth / 2 - MeasureText("Paused II", 100) / 2, screenHeight / 2, 100, DARKGREEN);
-            DrawText("Press SPACE to resume...", screenWidth / 2 - MeasureText("Press SPACE to resume...", 50) / 2, screenHeight / 2 + 200, 50, DARKGREEN);
-        }
-        EndDrawing();
-    }
-    saveScoreData(&scoreboard, scoreFileName);
-    UnloadTexture(spriteSheet);
-    // UnloadSound(fxBounce);
-    CloseAudioDevice();
-    CloseWindow(); // Close window and OpenGL context
-
-    return 0;
-}
-
-void loadScoreData(ScoreBoard *scoreboard, char *fileName)
-{
-    if (FileExists(fileName))
-    {
-        scoreboard->fileData = LoadFileText(fileName);
-    }
-    else
-        scoreboard->fileData = "0000\n0000\n0000\n0000\n0000\n";
-
-    scoreboard->scoreList = TextSplit(scoreboard->fileData, '\n', &scoreboard->storage);
-
-    for (int i = 0; i < scoreboard->storage; i++)
-    {
-        scoreboard->scoreData[i] = TextToInteger(scoreboard->scoreList[i]);
-    }
-}
-
-void appendHighscore(ScoreBoard *scoreboard, int score)
-{
-    scoreboard->scoreData[scoreboard->storage] = score;
-    for (int i = scoreboard->storage; i > 0; i--)
-    {
-        if (scoreboard->scoreData[i] > scoreboard->scoreData[i - 1])
-        {
-            int temp = scoreboard->scoreData[i - 1];
-            scoreboard->scoreData[i - 1] = scoreboard->scoreData[i];
-            scoreboard->scoreData[i] = temp;
+            ClearBackground(SKYBLUE);
+            drawCachedTextCentered(&text, "Loading...", screenWidth / 2, screenHeight / 2 - 80, 60, DARKGRAY);
+            DrawRectangle(screenWidth / 4, screenHeight / 2, screenWidth / 2, 20, DARKGRAY);
+            DrawRectangle(screenWidth / 4, screenHeight / 2, (int)(screenWidth / 2 * assetLoaderProgress(&loader)), 20, MAROON);
         }
-    }
-}
-
-void saveScoreData(ScoreBoard *scoreboard, char *filename)
-{
-    // Not working properly
-    // TODO: Save score data into a file
-    for (int i = 0; i < scoreboard->storage; i++)
-    {
-        scoreboard->scoreList[i] = TextFormat("%d", scoreboard->scoreData[i]);
-        printf(scoreboard->scoreList[i]);
-    }
-    char *delimiter = "\n";
-    char *endOfData = "\0";
-    int pos = -1;
-    scoreboard->fileData = TextJoin(scoreboard->scoreList, scoreboard->storage, delimiter);
-    TextAppend((char *)scoreboard->fileData, endOfData, &pos);
-    printf(scoreboard->fileData);
-    SaveFileText(filename, (char *)scoreboard->fileData);
-}
-
-void initBricks(Brick bricks[MAX_ROWS][MAX_COLS], int level)
-{
-    int totalRows = level % MAX_ROWS;
-    if (level >= MAX_ROWS)
-        totalRows = MAX_ROWS;
-
-    for (int i = 0; i < MAX_ROWS; i++)
-    {
-        int totalCols = GetRandomValue(MAX_COLS - 4, MAX_COLS);
-        if (totalCols % 2 == 0)
-            totalCols += 1;
-        float margin = (GetScreenWidth() - BRICK_WIDTH * totalCols) / 2;
-
-        bool skipped = GetRandomValue(0, 1) > 0;
-        bool alternate = GetRandomValue(0, 1) > 0;
-        int maxTier = level - 1;
-        if (maxTier >= BRICK_TIER)
-            maxTier = BRICK_TIER - 1;
-        int tiers[] = {GetRandomValue(0, maxTier), GetRandomValue(0, maxTier)};
-        int colorIndex = 0;
-        for (int j = 0; j < MAX_COLS; j++)
+        else
         {
-            if ((skipped && j % 2) || j >= totalCols || i >= totalRows)
-            {
-                bricks[i][j].broken = true;
-                continue;
-            }
-            else
-                bricks[i][j].broken = false;
-            bricks[i][j].width = BRICK_WIDTH;
-            bricks[i][j].height = BRICK_HEIGHT;
-            bricks[i][j].x = bricks[i][j].width * j + bricks[i][j].width / 2 + margin;
-            bricks[i][j].y = bricks[i][j].height * i + bricks[i][j].height / 2 + bricks[i][j].height;
-            bricks[i][j].collisionRect = getRect(bricks[i][j].x, bricks[i][j].y, bricks[i][j].width, bricks[i][j].height);
-
-            if (alternate)
-                colorIndex = (colorIndex + 1) % 2;
-            bricks[i][j].tier = tiers[colorIndex];
-            bricks[i][j].health = 3;
+            drawCachedTextCentered(&text, "Paused II", screenWidth / 2, screenHeight / 2, 100, DARKGREEN);
+            drawCachedTextCentered(&text, "Press SPACE to resume...", screenWidth / 2, screenHeight / 2 + 200, 50, DARKGREEN);
         }
-    }
-}
-
-void drawBricks(Brick bricks[MAX_ROWS][MAX_COLS], int rows, int cols, Texture2D spriteSheet, Rectangle srcRect)
-{
-    int index;
-    for (int i = 0; i < rows; i++)
-    {
-        for (int j = 0; j < cols; j++)
+        drawProfilerOverlay(10, 10);
+        SpriteBatchStats batchStats = takeSpriteBatchStats(&sprites);
+        if (profilerOverlayVisible())
         {
-            if (bricks[i][j].broken)
-                continue;
-            index = 3 - bricks[i][j].health;
-            bricks[i][j].srcRect = (Rectangle){srcRect.x + bricks[i][j].width * index, srcRect.y + bricks[i][j].height * bricks[i][j].tier, srcRect.width, srcRect.height};
-            DrawRectangleRec(bricks[i][j].collisionRect, WHITE);
-            DrawTextureRec(spriteSheet, bricks[i][j].srcRect, (Vector2){bricks[i][j].x - bricks[i][j].width / 2, bricks[i][j].y - bricks[i][j].height / 2}, WHITE);
+            DrawRectangle(10, 14 + 24 + 20 * PHASE_COUNT, 260, 24, Fade(BLACK, 0.7f));
+            DrawText(TextFormat("batch %d draws %d verts", batchStats.drawCalls, batchStats.vertices), 18, 18 + 24 + 20 * PHASE_COUNT, 16, GREEN);
         }
-    }
-}
-
-void paddleControl(Paddle *paddle)
-{
-    if (IsKeyDown(KEY_RIGHT))
-    {
-        paddle->x += paddle->speed * GetFrameTime();
-    }
-    else if (IsKeyDown(KEY_LEFT))
-    {
-        paddle->x -= paddle->speed * GetFrameTime();
-    }
-    if (paddle->x < paddle->width / 2)
-        paddle->x = paddle->width / 2;
-    else if (paddle->x > GetScreenWidth() - paddle->width / 2)
-        paddle->x = GetScreenWidth() - paddle->width / 2;
-}
+        drawMemtrackOverlay(screenWidth - 350, 10);
+        PROFILE_END(PHASE_DRAW);
 
-bool updateBall(Ball *ball)
-{
-    bool hitWall = false;
-    ball->x += ball->speedX * GetFrameTime();
-    ball->y += ball->speedY * GetFrameTime();
-    if (ball->y <= ball->radius)
-    {
-        ball->y = ball->radius;
-        ball->speedY *= -1;
-    }
-
-    if (ball->x <= ball->radius)
-    {
-        ball->x = ball->radius;
-        ball->speedX *= -1;
-        hitWall = true;
+        PROFILE_BEGIN(PHASE_PRESENT);
+        EndDrawing();
+        PROFILE_END(PHASE_PRESENT);
+        PROFILE_END_FRAME();
+        memtrackEndFrame();
     }
-    else if (ball->x >= GetScreenWidth() - ball->radius)
+    profilerShutdown();
+    if (game.state == LOADING)
+        game.state = resumeState;
+    // Quitting mid-round keeps the round for next time
+    if (canRewind && (game.state == PLAY || game.state == PAUSED))
+        saveSnapshot(saveFileName, &game, &particles);
+    unloadRewindBuffer(&rewind);
+    if (recordFile)
     {
-        ball->x = GetScreenWidth() - ball->radius;
-        ball->speedX *= -1;
-        hitWall = true;
+        recording.finalHash = hashGameState(&game);
+        if (!saveReplay(&recording, recordFile))
+            printf("Could not save replay %s\n", recordFile);
     }
-    return hitWall;
-}
+    unloadReplay(&recording);
+    unloadReplay(&playback);
+    stopChunkStream(&chunkStream);
+    unloadParticleSystem(&particles);
+    unloadSpriteBatch(&sprites);
+    unloadBrickLayer(&brickLayer);
+    unloadAssetLoader(&loader);
+    UnloadTexture(spriteSheet);
+    unloadSoundManager(&sounds);
+    CloseAudioDevice();
+    CloseWindow(); // Close window and OpenGL context
+    memtrackReportLeaks(stderr);
 
-void resetBall(Ball *ball, float x, float y)
-{
-    ball->x = x;
-    ball->y = y;
-    ball->speedX = 0;
-    ball->speedY = 0;
+    return 0;
 }
 
-bool paddleCollision(Ball *ball, Paddle *paddle)
+GameInput readInput(void)
 {
-    Vector2 center = {ball->x, ball->y};
-    paddle->collisionRect = getRect(paddle->x, paddle->y, paddle->width, paddle->height);
-    if (CheckCollisionCircleRec(center, ball->radius, paddle->collisionRect) && ball->y <= paddle->y + paddle->height / 2)
+    // Bit order matches the INPUT_* flags
+    const int keys[] = {KEY_LEFT, KEY_RIGHT, KEY_UP, KEY_DOWN, KEY_SPACE, KEY_ENTER};
+    GameInput input = {0, 0};
+    for (int i = 0; i < (int)SIZEOF(keys); i++)
     {
-
-        // ball.speedX *= -1;
-        ball->y = paddle->y - paddle->height / 2 - ball->radius;
-        ball->speedY *= -1;
-
-        if (ball->speedX < 0 && ball->x < paddle->x)
-        {
-            ball->speedX = -BALL_SPEED + (paddle->x - ball->x) * -10;
-        }
-        else if (ball->speedX > 0 && ball->x > paddle->x)
-        {
-            ball->speedX = BALL_SPEED + (ball->x - paddle->x) * 10;
-        }
-
-        return true;
+        if (IsKeyDown(keys[i]))
+            input.down |= 1u << i;
+        if (IsKeyPressed(keys[i]))
+            input.pressed |= 1u << i;
     }
-    return false;
+    return input;
 }
 
-bool brickCollisions(Ball *ball, Brick bricks[MAX_ROWS][MAX_COLS], int *score, Emitter *emitter)
+void updateButtons(Button buttons[], int size, int activeIndex, Color activeColor, Color normalColor)
 {
-    Vector2 center = {ball->x, ball->y};
-    Color colors[] = {RED, DARKBLUE, DARKGREEN, BROWN, YELLOW, PURPLE};
-    int colorIndex = 0;
-    for (int i = 0; i < MAX_ROWS; i++)
-    {
-        for (int j = 0; j < MAX_COLS; j++)
-        {
-            if (bricks[i][j].broken)
-                continue;
-
-            if (CheckCollisionCircleRec(center, 2 * ball->radius, bricks[i][j].collisionRect))
-            {
-                bool isSideCollision = (ball->x < (bricks[i][j].x - bricks[i][j].width / 2) || ball->x > (bricks[i][j].x + bricks[i][j].width / 2));
-                if (isSideCollision)
-                {
-                    ball->speedX *= -1;
-                    if (ball->x < (bricks[i][j].x))
-                        ball->x -= ball->radius;
-                    else
-                        ball->x += ball->radius;
-                }
-                else
-                {
-                    ball->speedY *= -1;
-                    if (ball->y < (bricks[i][j].y))
-                        ball->y -= ball->radius;
-                    else
-                        ball->y += ball->radius;
-                }
-
-                if (bricks[i][j].tier == 0)
-                {
-                    bricks[i][j].health--;
-                    *score += 1;
-                    if (bricks[i][j].health <= 0)
-                    {
-                        bricks[i][j].broken = true;
-                        *score += 1;
-                    }
-                }
-                else if (bricks[i][j].tier > 0)
-                {
-                    *score += bricks[i][j].tier;
-                    colorIndex = bricks[i][j].tier;
-                    bricks[i][j].tier--;
-                }
-
-                initEmitter(emitter, bricks[i][j].collisionRect, colors[colorIndex]);
-                return true;
-            }
-        }
-    }
-    return false;
-}
-
-bool switchButtons(Button buttons[], int size, Color activeColor, Color normalColor)
-{
-    // Select menu buttons
-    bool pressed = false;
-    if (IsKeyPressed(KEY_UP) || IsKeyPressed(KEY_DOWN))
-    {
-        for (int i = 0; i < size; i++)
-        {
-            buttons[i].active = !buttons[i].active;
-        }
-        pressed = true;
-    }
+    // Highlight the selected menu button
     for (int i = 0; i < size; i++)
     {
+        buttons[i].active = (i == activeIndex);
         if (buttons[i].active)
             buttons[i].color = activeColor;
         else
             buttons[i].color = normalColor;
     }
-    return pressed;
 }
 
-void drawButtons(Button buttons[], int total, int fontSize)
+void drawButtons(TextCache *text, Button buttons[], int total, int fontSize)
 {
     for (int i = 0; i < total; i++)
     {
-        DrawText(buttons[i].name, GetScreenWidth() / 2 - MeasureText(buttons[i].name, fontSize) / 2, GetScreenHeight() / 2 + (fontSize + 15) * i, fontSize, buttons[i].color);
-    }
-}
-
-void initEmitter(Emitter *emitter, Rectangle area, Color color)
-{
-
-    emitter->active = true;
-    emitter->particleSys.radius = emitter->size;
-    emitter->particleSys.color = color;
-    emitter->particleSys.fade = emitter->fade;
-    emitter->particleSys.gravity = emitter->gravity;
-    emitter->particleSys.area = area;
-    initParticleSystem(&emitter->particleSys);
-}
-
-void initParticleSystem(ParticleSystem *particleSystem)
-{
-    for (int i = 0; i < MAX_PARTICLES; i++)
-    {
-        particleSystem->particles[i].position = (Vector2){GetRandomValue(particleSystem->area.x, particleSystem->area.x + particleSystem->area.width), GetRandomValue(particleSystem->area.y, particleSystem->area.y + particleSystem->area.height)};
-        particleSystem->particles[i].color = particleSystem->color;
-        particleSystem->particles[i].alpha = 1.0f;
-        particleSystem->particles[i].radius = particleSystem->radius;
-        particleSystem->particles[i].active = true;
-    }
-}
-
-void updateParticleSystem(Emitter *emitter)
-{
-
-    emitter->active = false;
-    for (int i = 0; i < MAX_PARTICLES; i++)
-    {
-        if (!emitter->particleSys.particles[i].active)
-            continue;
-        emitter->active = true;
-        emitter->particleSys.particles[i].position.x += GetRandomValue(-3, 3);
-        emitter->particleSys.particles[i].position.y += emitter->particleSys.gravity;
-        emitter->particleSys.particles[i].alpha -= emitter->particleSys.fade;
-        if (emitter->particleSys.particles[i].alpha <= 0.0f)
-            emitter->particleSys.particles[i].active = false;
+        drawCachedTextCentered(text, buttons[i].name, GetScreenWidth() / 2, GetScreenHeight() / 2 + (fontSize + 15) * i, fontSize, buttons[i].color);
     }
 }
 
-void drawParticleSystem(ParticleSystem particleSys)
+// Every ball at its blended position
+void batchBalls(SpriteBatch *batch, Texture2D spriteSheet, const SpriteFrame *frame, const BallSet *balls, float alpha)
 {
-    for (int i = 0; i < MAX_PARTICLES; i++)
+    for (int i = 0; i < balls->count; i++)
     {
-        if (!particleSys.particles[i].active)
-            continue;
-        DrawRectangle(particleSys.particles[i].position.x, particleSys.particles[i].position.y, particleSys.radius, particleSys.radius, Fade(particleSys.particles[i].color, particleSys.particles[i].alpha));
-        // DrawCircle(particleSystem->particles[i].position.x, particleSystem->particles[i].position.y, particleSystem->particles[i].radius, Fade(particleSystem->particles[i].color, particleSystem->particles[i].alpha));
+        float x = balls->prevX[i] + (balls->x[i] - balls->prevX[i]) * alpha;
+        float y = balls->prevY[i] + (balls->y[i] - balls->prevY[i]) * alpha;
+        batchSpriteFrame(batch, LAYER_SPRITES, spriteSheet, frame, x - balls->radius, y - balls->radius, WHITE);
     }
 }
 
-void drawHearts(Texture2D spriteSheet, Rectangle srcRect, float x, float y, int lives)
+void batchHearts(SpriteBatch *batch, Texture2D spriteSheet, const SpriteAtlas *atlas, float x, float y, int lives)
 {
-    Rectangle heart;
+    const SpriteFrame *heart;
     for (int i = 0; i < 3; i++)
     {
         if (lives - i > 0)
         {
-            heart = srcRect;
+            heart = &atlas->heartFull;
         }
         else
         {
-            heart = (Rectangle){srcRect.x, srcRect.y + 32 * 2, srcRect.width, srcRect.height};
+            heart = &atlas->heartEmpty;
         }
-        Vector2 pos = {x + (heart.width + 2) * i, y};
-        DrawTextureRec(spriteSheet, heart, pos, WHITE);
+        batchSpriteFrame(batch, LAYER_SPRITES, spriteSheet, heart, x + (SPRITE_SIZE + 2) * i, y, WHITE);
     }
 }
 
@@ -0,0 +1,95 @@
+#include "brick_layer.h"
+
+// Cells are placed relative to the field's top so a scrolling field only
+// moves the layer, not what is cached in it
+static Rectangle cellRect(const BrickField *field, int row, int col)
+{
+    return (Rectangle){brickX(field, row, col) - BRICK_WIDTH / 2, BRICK_HEIGHT * row, BRICK_WIDTH, BRICK_HEIGHT};
+}
+
+// White backing in layer 0, the sprite over it in layer 1, so a full redraw
+// is two runs whatever the brick count
+static void batchBrickCell(const BrickLayer *layer, SpriteBatch *batch, const BrickField *field, int row, int col)
+{
+    int index = brickIndex(row, col);
+    const SpriteFrame *frame = brickFrame(layer->atlas, field->tier[index], field->health[index]);
+    Rectangle cell = cellRect(field, row, col);
+    batchRectangle(batch, 0, cell, WHITE);
+    batchSpriteFrame(batch, 1, layer->spriteSheet, frame, cell.x, cell.y, WHITE);
+}
+
+void initBrickLayer(BrickLayer *layer, int width, int height, Texture2D spriteSheet, const SpriteAtlas *atlas)
+{
+    layer->target = LoadRenderTexture(width, height);
+    layer->spriteSheet = spriteSheet;
+    layer->atlas = atlas;
+}
+
+void unloadBrickLayer(BrickLayer *layer)
+{
+    UnloadRenderTexture(layer->target);
+}
+
+// Re-renders what changed since the last call and clears the dirty flags.
+// Returns the number of cells drawn.
+int updateBrickLayer(BrickLayer *layer, BrickField *field, SpriteBatch *batch)
+{
+    int drawn = 0;
+    if (field->layoutDirty)
+    {
+        BeginTextureMode(layer->target);
+        ClearBackground(BLANK);
+        for (int i = 0; i < field->rows; i++)
+        {
+            uint64_t live = field->live[i];
+            while (live)
+            {
+                int j = lowestBit(live);
+                live &= live - 1;
+                batchBrickCell(layer, batch, field, i, j);
+                drawn++;
+            }
+            field->dirty[i] = 0;
+        }
+        flushSpriteBatch(batch);
+        EndTextureMode();
+        field->layoutDirty = false;
+        return drawn;
+    }
+
+    for (int i = 0; i < field->rows; i++)
+    {
+        uint64_t dirty = field->dirty[i];
+        if (!dirty)
+            continue;
+        if (drawn == 0)
+            BeginTextureMode(layer->target);
+        while (dirty)
+        {
+            int j = lowestBit(dirty);
+            dirty &= dirty - 1;
+            // Wipe just this cell, then redraw it if the brick survived
+            Rectangle cell = cellRect(field, i, j);
+            BeginScissorMode(cell.x, cell.y, cell.width, cell.height);
+            ClearBackground(BLANK);
+            if (isBrickLive(field, i, j))
+            {
+                batchBrickCell(layer, batch, field, i, j);
+                flushSpriteBatch(batch);
+            }
+            EndScissorMode();
+            drawn++;
+        }
+        field->dirty[i] = 0;
+    }
+    if (drawn > 0)
+        EndTextureMode();
+    return drawn;
+}
+
+void batchBrickLayer(const BrickLayer *layer, SpriteBatch *batch, int depth, float top)
+{
+    // Render textures are stored upside down
+    Rectangle source = {0, 0, layer->target.texture.width, -layer->target.texture.height};
+    batchTextureRec(batch, depth, layer->target.texture, source, (Vector2){0, top}, WHITE);
+}
@@ -0,0 +1,25 @@
+#ifndef BREAKOUT_BRICK_LAYER_H
+#define BREAKOUT_BRICK_LAYER_H
+
+#include "raylib.h"
+#include "bricks.h"
+#include "sprite_atlas.h"
+#include "sprite_batch.h"
+
+// Brick field pre-rendered into a texture. Only cells flagged dirty in the
+// field are redrawn, and the whole layer is drawn as one textured quad at the
+// field's top.
+// Cells are drawn through the sprite batch, which must be empty on update.
+typedef struct BrickLayer
+{
+    RenderTexture2D target;
+    Texture2D spriteSheet;
+    const SpriteAtlas *atlas;
+} BrickLayer;
+
+void initBrickLayer(BrickLayer *layer, int width, int height, Texture2D spriteSheet, const SpriteAtlas *atlas);
+void unloadBrickLayer(BrickLayer *layer);
+int updateBrickLayer(BrickLayer *layer, BrickField *field, SpriteBatch *batch);
+void batchBrickLayer(const BrickLayer *layer, SpriteBatch *batch, int depth, float top);
+
+#endif
@@ -0,0 +1,122 @@
+#include "bricks.h"
+
+#include <math.h>
+#include <string.h>
+
+void initBrickField(BrickField *field, int rows, int cols)
+{
+    field->rows = rows < FIELD_MAX_ROWS ? rows : FIELD_MAX_ROWS;
+    field->cols = cols < FIELD_MAX_COLS ? cols : FIELD_MAX_COLS;
+    field->top = BRICK_HEIGHT;
+    field->liveCount = 0;
+    for (int i = 0; i < FIELD_MAX_ROWS; i++)
+    {
+        field->rowX[i] = 0;
+        field->live[i] = 0;
+        field->dirty[i] = 0;
+    }
+    memset(field->health, 0, sizeof(field->health));
+    memset(field->tier, 0, sizeof(field->tier));
+    field->layoutDirty = true;
+}
+
+// One row of a level: a centred odd number of columns, optionally every
+// other one skipped, with one or two alternating tiers up to maxTier. The
+// random draws happen even when the row is left empty, so a layout only
+// depends on the seed. Returns the live mask.
+uint64_t generateBrickRow(Rng *rng, int cols, int screenWidth, int maxTier, bool filled, float *rowX, unsigned char *health, unsigned char *tier)
+{
+    int totalCols = rngRange(rng, cols - 4, cols);
+    if (totalCols % 2 == 0)
+        totalCols += 1;
+    if (totalCols > cols)
+        totalCols = cols;
+    *rowX = (screenWidth - BRICK_WIDTH * totalCols) / 2;
+
+    bool skipped = rngRange(rng, 0, 1) > 0;
+    bool alternate = rngRange(rng, 0, 1) > 0;
+    int tiers[] = {rngRange(rng, 0, maxTier), rngRange(rng, 0, maxTier)};
+    int colorIndex = 0;
+    uint64_t live = 0;
+    // Empty cells are zeroed too so equal layouts are equal byte for byte
+    memset(health, 0, cols);
+    memset(tier, 0, cols);
+    for (int j = 0; j < cols; j++)
+    {
+        if ((skipped && j % 2) || j >= totalCols || !filled)
+            continue;
+        live |= (uint64_t)1 << j;
+
+        if (alternate)
+            colorIndex = (colorIndex + 1) % 2;
+        tier[j] = tiers[colorIndex];
+        health[j] = BRICK_HEALTH;
+    }
+    return live;
+}
+
+void initBricks(BrickField *field, int level, int screenWidth, Rng *rng)
+{
+    int totalRows = level % field->rows;
+    if (level >= field->rows)
+        totalRows = field->rows;
+    int maxTier = level - 1;
+    if (maxTier >= BRICK_TIER)
+        maxTier = BRICK_TIER - 1;
+
+    field->liveCount = 0;
+    field->layoutDirty = true;
+    for (int i = 0; i < field->rows; i++)
+    {
+        int index = brickIndex(i, 0);
+        field->live[i] = generateBrickRow(rng, field->cols, screenWidth, maxTier, i < totalRows, &field->rowX[i], &field->health[index], &field->tier[index]);
+        field->liveCount += popCount(field->live[i]);
+    }
+}
+
+// Applies one hit to a brick and returns the color index for its particles
+int hitBrick(BrickField *field, int row, int col, int *score)
+{
+    int index = brickIndex(row, col);
+    int colorIndex = 0;
+    field->dirty[row] |= (uint64_t)1 << col;
+    if (field->tier[index] == 0)
+    {
+        field->health[index]--;
+        *score += 1;
+        if (field->health[index] == 0)
+        {
+            field->live[row] &= ~((uint64_t)1 << col);
+            field->liveCount--;
+            *score += 1;
+        }
+    }
+    else
+    {
+        *score += field->tier[index];
+        colorIndex = field->tier[index];
+        field->tier[index]--;
+    }
+    return colorIndex;
+}
+
+// Columns of a row whose bricks overlap [minX, maxX]
+uint64_t columnMask(const BrickField *field, int row, float minX, float maxX)
+{
+    int first = (int)floorf((minX - field->rowX[row]) / BRICK_WIDTH);
+    int last = (int)floorf((maxX - field->rowX[row]) / BRICK_WIDTH);
+    if (first < 0)
+        first = 0;
+    if (last > field->cols - 1)
+        last = field->cols - 1;
+    if (last < first)
+        return 0;
+    int span = last - first + 1;
+    uint64_t bits = span >= 64 ? ~(uint64_t)0 : (((uint64_t)1 << span) - 1);
+    return bits << first;
+}
+
+int rowOf(const BrickField *field, float y)
+{
+    return (int)floorf((y - field->top) / BRICK_HEIGHT);
+}
@@ -0,0 +1,90 @@
+#ifndef BREAKOUT_BRICKS_H
+#define BREAKOUT_BRICKS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "rng.h"
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#define BRICK_TIER 5
+#define BRICK_WIDTH 64
+#define BRICK_HEIGHT 32
+#define BRICK_HEALTH 3
+#define FIELD_MAX_ROWS 32
+#define FIELD_MAX_COLS 64
+
+// Packed brick grid. Each row keeps a bitmask of live bricks, health and tier
+// live in flat byte arrays indexed by brickIndex(), and liveCount is kept in
+// step with the masks so clearing a level is a single compare. Cells whose
+// look changed are flagged in dirty, a new layout sets layoutDirty; both are
+// cleared by whoever caches the rendered field.
+typedef struct BrickField
+{
+    int rows, cols;
+    float top;
+    float rowX[FIELD_MAX_ROWS];
+    uint64_t live[FIELD_MAX_ROWS];
+    uint64_t dirty[FIELD_MAX_ROWS];
+    bool layoutDirty;
+    unsigned char health[FIELD_MAX_ROWS * FIELD_MAX_COLS];
+    unsigned char tier[FIELD_MAX_ROWS * FIELD_MAX_COLS];
+    int liveCount;
+} BrickField;
+
+void initBrickField(BrickField *field, int rows, int cols);
+uint64_t generateBrickRow(Rng *rng, int cols, int screenWidth, int maxTier, bool filled, float *rowX, unsigned char *health, unsigned char *tier);
+void initBricks(BrickField *field, int level, int screenWidth, Rng *rng);
+int hitBrick(BrickField *field, int row, int col, int *score);
+uint64_t columnMask(const BrickField *field, int row, float minX, float maxX);
+int rowOf(const BrickField *field, float y);
+
+static inline int brickIndex(int row, int col)
+{
+    return row * FIELD_MAX_COLS + col;
+}
+
+static inline bool isBrickLive(const BrickField *field, int row, int col)
+{
+    return (field->live[row] >> col) & 1;
+}
+
+static inline float brickX(const BrickField *field, int row, int col)
+{
+    return field->rowX[row] + BRICK_WIDTH * col + BRICK_WIDTH / 2;
+}
+
+static inline float brickY(const BrickField *field, int row)
+{
+    return field->top + BRICK_HEIGHT * row + BRICK_HEIGHT / 2;
+}
+
+static inline bool isLevelCleared(const BrickField *field)
+{
+    return field->liveCount == 0;
+}
+
+// Index of the lowest set bit, mask must be non-zero
+static inline int lowestBit(uint64_t mask)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward64(&index, mask);
+    return (int)index;
+#else
+    return __builtin_ctzll(mask);
+#endif
+}
+
+static inline int popCount(uint64_t mask)
+{
+#if defined(_MSC_VER)
+    return (int)__popcnt64(mask);
+#else
+    return __builtin_popcountll(mask);
+#endif
+}
+
+#endif
@@ -0,0 +1,123 @@
+#ifndef BREAKOUT_BYTE_STREAM_H
+#define BREAKOUT_BYTE_STREAM_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "rng.h"
+
+// Little-endian cursor over a byte buffer. Writes past the end and reads past
+// the end only set the failed flag, so callers check once at the end.
+typedef struct ByteStream
+{
+    unsigned char *data;
+    const unsigned char *input;
+    size_t size;
+    size_t position;
+    bool failed;
+} ByteStream;
+
+static inline void putBytes(ByteStream *out, const void *bytes, size_t count)
+{
+    if (out->failed || out->size - out->position < count)
+    {
+        out->failed = true;
+        return;
+    }
+    memcpy(out->data + out->position, bytes, count);
+    out->position += count;
+}
+
+static inline void putU8(ByteStream *out, uint32_t value)
+{
+    unsigned char byte = (unsigned char)value;
+    putBytes(out, &byte, 1);
+}
+
+static inline void putU16(ByteStream *out, uint32_t value)
+{
+    unsigned char bytes[2] = {value & 0xff, (value >> 8) & 0xff};
+    putBytes(out, bytes, 2);
+}
+
+static inline void putU32(ByteStream *out, uint32_t value)
+{
+    unsigned char bytes[4] = {value & 0xff, (value >> 8) & 0xff, (value >> 16) & 0xff, value >> 24};
+    putBytes(out, bytes, 4);
+}
+
+static inline void putU64(ByteStream *out, uint64_t value)
+{
+    putU32(out, (uint32_t)value);
+    putU32(out, (uint32_t)(value >> 32));
+}
+
+static inline void putF32(ByteStream *out, float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    putU32(out, bits);
+}
+
+static inline void putRng(ByteStream *out, const Rng *rng)
+{
+    for (int i = 0; i < 4; i++)
+        putU32(out, rng->s[i]);
+}
+
+static inline void getBytes(ByteStream *in, void *bytes, size_t count)
+{
+    if (in->failed || in->size - in->position < count)
+    {
+        in->failed = true;
+        memset(bytes, 0, count);
+        return;
+    }
+    memcpy(bytes, in->input + in->position, count);
+    in->position += count;
+}
+
+static inline uint32_t getU8(ByteStream *in)
+{
+    unsigned char byte;
+    getBytes(in, &byte, 1);
+    return byte;
+}
+
+static inline uint32_t getU16(ByteStream *in)
+{
+    unsigned char bytes[2];
+    getBytes(in, bytes, 2);
+    return bytes[0] | (uint32_t)bytes[1] << 8;
+}
+
+static inline uint32_t getU32(ByteStream *in)
+{
+    unsigned char bytes[4];
+    getBytes(in, bytes, 4);
+    return bytes[0] | (uint32_t)bytes[1] << 8 | (uint32_t)bytes[2] << 16 | (uint32_t)bytes[3] << 24;
+}
+
+static inline uint64_t getU64(ByteStream *in)
+{
+    uint64_t lo = getU32(in);
+    return lo | (uint64_t)getU32(in) << 32;
+}
+
+static inline float getF32(ByteStream *in)
+{
+    uint32_t bits = getU32(in);
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+static inline void getRng(ByteStream *in, Rng *rng)
+{
+    for (int i = 0; i < 4; i++)
+        rng->s[i] = getU32(in);
+}
+
+#endif
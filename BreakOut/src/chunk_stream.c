@@ -0,0 +1,89 @@
+#include "chunk_stream.h"
+
+#include <string.h>
+
+static void *streamMain(void *arg)
+{
+    ChunkStream *stream = arg;
+    pthread_mutex_lock(&stream->lock);
+    for (;;)
+    {
+        while (!stream->stop && (!stream->active || stream->produced - stream->consumed >= CHUNK_STREAM_RING))
+            pthread_cond_wait(&stream->wake, &stream->lock);
+        if (stream->stop)
+            break;
+        uint64_t seed = stream->seed;
+        uint32_t index = stream->produced;
+        uint32_t generation = stream->generation;
+        int cols = stream->cols;
+        int screenWidth = stream->screenWidth;
+        pthread_mutex_unlock(&stream->lock);
+
+        // Generated outside the lock; a retarget in the meantime discards it
+        BrickChunk chunk;
+        generateChunk(&chunk, seed, index, cols, screenWidth);
+
+        pthread_mutex_lock(&stream->lock);
+        if (stream->generation == generation)
+        {
+            stream->ring[index % CHUNK_STREAM_RING] = chunk;
+            stream->produced++;
+        }
+    }
+    pthread_mutex_unlock(&stream->lock);
+    return 0;
+}
+
+void startChunkStream(ChunkStream *stream)
+{
+    memset(stream, 0, sizeof(*stream));
+    pthread_mutex_init(&stream->lock, 0);
+    pthread_cond_init(&stream->wake, 0);
+    stream->started = pthread_create(&stream->thread, 0, streamMain, stream) == 0;
+}
+
+void stopChunkStream(ChunkStream *stream)
+{
+    if (stream->started)
+    {
+        pthread_mutex_lock(&stream->lock);
+        stream->stop = true;
+        pthread_cond_signal(&stream->wake);
+        pthread_mutex_unlock(&stream->lock);
+        pthread_join(stream->thread, 0);
+        stream->started = false;
+    }
+    pthread_mutex_destroy(&stream->lock);
+    pthread_cond_destroy(&stream->wake);
+}
+
+bool takeChunk(ChunkStream *stream, uint64_t seed, uint32_t index, int cols, int screenWidth, BrickChunk *out)
+{
+    // Busy means the worker is publishing; the caller is quicker making the
+    // chunk itself than waiting
+    if (!stream->started || pthread_mutex_trylock(&stream->lock) != 0)
+    {
+        stream->fallbacks++;
+        return false;
+    }
+    bool ready = stream->active && stream->seed == seed && stream->cols == cols && stream->screenWidth == screenWidth && index >= stream->consumed && index < stream->produced;
+    if (ready)
+    {
+        *out = stream->ring[index % CHUNK_STREAM_RING];
+        stream->consumed = index + 1;
+    }
+    else
+    {
+        // Restart just past the chunk the caller is about to make
+        stream->seed = seed;
+        stream->cols = cols;
+        stream->screenWidth = screenWidth;
+        stream->consumed = stream->produced = index + 1;
+        stream->generation++;
+        stream->active = true;
+        stream->fallbacks++;
+    }
+    pthread_cond_signal(&stream->wake);
+    pthread_mutex_unlock(&stream->lock);
+    return ready;
+}
@@ -0,0 +1,44 @@
+#ifndef BREAKOUT_CHUNK_STREAM_H
+#define BREAKOUT_CHUNK_STREAM_H
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "endless.h"
+
+#define CHUNK_STREAM_RING 4
+
+// Worker thread that generates endless-mode chunks ahead of the sim into a
+// fixed ring. Chunks [consumed, produced) are ready; the worker sleeps while
+// the ring is full. The sim never waits on it: takeChunk only tries the lock,
+// and a chunk that is not ready (or a seed or index the stream is not on,
+// after a rewind or a new run) is generated by the caller and the stream
+// restarts just past it. Memory is the ring and nothing else, however long
+// the run.
+typedef struct ChunkStream
+{
+    BrickChunk ring[CHUNK_STREAM_RING];
+    uint64_t seed;
+    uint32_t consumed;
+    uint32_t produced;
+    uint32_t generation;
+    bool active;
+    bool stop;
+    int cols;
+    int screenWidth;
+    int fallbacks;
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    pthread_t thread;
+    bool started;
+} ChunkStream;
+
+// Without a thread the stream stays idle and every chunk is a fallback
+void startChunkStream(ChunkStream *stream);
+void stopChunkStream(ChunkStream *stream);
+// Copies the chunk generateChunk would make for these arguments into out;
+// false if the caller has to generate it
+bool takeChunk(ChunkStream *stream, uint64_t seed, uint32_t index, int cols, int screenWidth, BrickChunk *out);
+
+#endif
@@ -0,0 +1,88 @@
+#include "endless.h"
+#include "chunk_stream.h"
+#include "sim.h"
+
+#include <string.h>
+
+void generateChunk(BrickChunk *chunk, uint64_t seed, uint32_t index, int cols, int screenWidth)
+{
+    Rng rng;
+    rngSeed(&rng, seed, RNG_STREAM_ENDLESS + ((uint64_t)index << 8));
+    int maxTier = index < BRICK_TIER - 1 ? (int)index : BRICK_TIER - 1;
+    chunk->seed = seed;
+    chunk->index = index;
+    for (int i = 0; i < ENDLESS_CHUNK_ROWS; i++)
+    {
+        int cell = i * FIELD_MAX_COLS;
+        chunk->live[i] = generateBrickRow(&rng, cols, screenWidth, maxTier, true, &chunk->rowX[i], &chunk->health[cell], &chunk->tier[cell]);
+    }
+}
+
+// Moves every row down one, dropping the bottom one, and feeds the run's next
+// row in at the top. Bricks left in the dropped row cost a life.
+static unsigned int pushRow(GameState *game)
+{
+    BrickField *field = &game->bricks;
+    unsigned int events = 0;
+    int last = field->rows - 1;
+    if (field->live[last])
+    {
+        field->liveCount -= popCount(field->live[last]);
+        game->lives--;
+        events |= EVENT_FALL;
+    }
+    memmove(&field->rowX[1], &field->rowX[0], last * sizeof(field->rowX[0]));
+    memmove(&field->live[1], &field->live[0], last * sizeof(field->live[0]));
+    memmove(&field->dirty[1], &field->dirty[0], last * sizeof(field->dirty[0]));
+    memmove(&field->health[brickIndex(1, 0)], field->health, last * FIELD_MAX_COLS);
+    memmove(&field->tier[brickIndex(1, 0)], field->tier, last * FIELD_MAX_COLS);
+
+    uint32_t index = game->endlessRows / ENDLESS_CHUNK_ROWS;
+    int row = game->endlessRows % ENDLESS_CHUNK_ROWS;
+    BrickChunk *chunk = &game->chunk;
+    if (row == 0 || chunk->seed != game->endlessSeed || chunk->index != index)
+    {
+        if (!game->chunkStream || !takeChunk(game->chunkStream, game->endlessSeed, index, field->cols, game->screenWidth, chunk))
+            generateChunk(chunk, game->endlessSeed, index, field->cols, game->screenWidth);
+    }
+    field->rowX[0] = chunk->rowX[row];
+    field->live[0] = chunk->live[row];
+    field->dirty[0] = 0;
+    memcpy(field->health, &chunk->health[row * FIELD_MAX_COLS], FIELD_MAX_COLS);
+    memcpy(field->tier, &chunk->tier[row * FIELD_MAX_COLS], FIELD_MAX_COLS);
+    field->liveCount += popCount(field->live[0]);
+    field->layoutDirty = true;
+
+    game->endlessRows++;
+    game->level = (int)index + 1;
+    return events;
+}
+
+void startEndless(GameState *game)
+{
+    // The run's seed comes from the level stream so a replay replays it
+    uint64_t high = rngNext(&game->levelRng);
+    uint64_t low = rngNext(&game->levelRng);
+    game->endless = true;
+    game->endlessSeed = high << 32 | low;
+    game->endlessRows = 0;
+    initBrickField(&game->bricks, ENDLESS_FIELD_ROWS, MAX_COLS);
+    game->bricks.top = 0;
+    for (int i = 0; i < ENDLESS_START_ROWS; i++)
+        pushRow(game);
+}
+
+unsigned int scrollEndless(GameState *game, float dt)
+{
+    int level = game->level < ENDLESS_MAX_LEVEL ? game->level : ENDLESS_MAX_LEVEL;
+    BrickField *field = &game->bricks;
+    field->top += (ENDLESS_SCROLL_SPEED + ENDLESS_SCROLL_STEP * level) * dt;
+    unsigned int events = 0;
+    // New rows slide in from above the screen
+    while (field->top > 0)
+    {
+        field->top -= BRICK_HEIGHT;
+        events |= pushRow(game);
+    }
+    return events;
+}
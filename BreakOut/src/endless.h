@@ -0,0 +1,41 @@
+#ifndef BREAKOUT_ENDLESS_H
+#define BREAKOUT_ENDLESS_H
+
+#include <stdint.h>
+
+#include "bricks.h"
+
+#define ENDLESS_CHUNK_ROWS 8
+// Visible rows; the bottom one leaving the field costs a life if it still
+// has bricks in it
+#define ENDLESS_FIELD_ROWS 9
+// Rows already on screen when a run starts
+#define ENDLESS_START_ROWS 3
+// Pixels per second, sped up for every chunk up to ENDLESS_MAX_LEVEL
+#define ENDLESS_SCROLL_SPEED 3.0f
+#define ENDLESS_SCROLL_STEP 0.5f
+#define ENDLESS_MAX_LEVEL 10
+
+// A run of rows for endless mode. Its content depends only on the run's
+// seed and the chunk index, so a chunk made ahead on another thread is
+// identical to one the sim makes itself.
+typedef struct BrickChunk
+{
+    uint64_t seed;
+    uint32_t index;
+    float rowX[ENDLESS_CHUNK_ROWS];
+    uint64_t live[ENDLESS_CHUNK_ROWS];
+    unsigned char health[ENDLESS_CHUNK_ROWS * FIELD_MAX_COLS];
+    unsigned char tier[ENDLESS_CHUNK_ROWS * FIELD_MAX_COLS];
+} BrickChunk;
+
+// Rows follow initBricks' rules for level index + 1, every row filled
+void generateChunk(BrickChunk *chunk, uint64_t seed, uint32_t index, int cols, int screenWidth);
+
+struct GameState;
+
+void startEndless(struct GameState *game);
+// Scrolls the field down and feeds in new rows at the top; returns events
+unsigned int scrollEndless(struct GameState *game, float dt);
+
+#endif
@@ -0,0 +1,175 @@
+#include "env_batch.h"
+#include "memtrack.h"
+
+#include <stdlib.h>
+
+static const float ballRadius = SPRITE_SIZE / 2;
+static const float paddleWidth = SPRITE_SIZE * 3;
+static const float paddleHeight = SPRITE_SIZE;
+
+static float paddleY(const EnvBatch *batch)
+{
+    return batch->screenHeight - 80;
+}
+
+static void serveEnv(EnvBatch *batch, int env)
+{
+    batch->ballX[env] = batch->paddleX[env];
+    batch->ballY[env] = paddleY(batch) - paddleHeight - ballRadius;
+    batch->ballSpeedX[env] = BALL_SPEED;
+    batch->ballSpeedY[env] = BALL_SPEED;
+}
+
+static void writeObservation(EnvBatch *batch, int env)
+{
+    float *obs = &batch->obs[env * ENV_OBS_SIZE];
+    const BrickField *bricks = &batch->bricks[env];
+    obs[OBS_BALL_X] = batch->ballX[env] / batch->screenWidth;
+    obs[OBS_BALL_Y] = batch->ballY[env] / batch->screenHeight;
+    obs[OBS_BALL_SPEED_X] = batch->ballSpeedX[env] / BALL_SPEED;
+    obs[OBS_BALL_SPEED_Y] = batch->ballSpeedY[env] / BALL_SPEED;
+    obs[OBS_PADDLE_X] = batch->paddleX[env] / batch->screenWidth;
+    obs[OBS_BRICKS_LEFT] = (float)bricks->liveCount / (bricks->rows * bricks->cols);
+    obs[OBS_LIVES] = batch->lives[env];
+}
+
+bool initEnvBatch(EnvBatch *batch, int count, int screenWidth, int screenHeight, int level, uint64_t seed)
+{
+    // Single block carved into the parallel arrays, widest types first
+    size_t size = (size_t)count * (sizeof(BrickField) + sizeof(Rng) + (6 + ENV_OBS_SIZE) * sizeof(float) + 2 * sizeof(int) + 2);
+    char *block = memAlloc(size, MEM_SIM);
+    if (!block)
+    {
+        batch->count = 0;
+        return false;
+    }
+    batch->bricks = (BrickField *)block;
+    batch->rng = (Rng *)(batch->bricks + count);
+    batch->ballX = (float *)(batch->rng + count);
+    batch->ballY = batch->ballX + count;
+    batch->ballSpeedX = batch->ballY + count;
+    batch->ballSpeedY = batch->ballSpeedX + count;
+    batch->paddleX = batch->ballSpeedY + count;
+    batch->reward = batch->paddleX + count;
+    batch->obs = batch->reward + count;
+    batch->lives = (int *)(batch->obs + (size_t)count * ENV_OBS_SIZE);
+    batch->score = batch->lives + count;
+    batch->done = (unsigned char *)(batch->score + count);
+    batch->moving = batch->done + count;
+
+    batch->count = count;
+    batch->screenWidth = screenWidth;
+    batch->screenHeight = screenHeight;
+    batch->level = level;
+    batch->dt = 1.0f / SIM_TICK_RATE;
+    for (int env = 0; env < count; env++)
+    {
+        // Independent level streams per environment
+        rngSeed(&batch->rng[env], seed + env, RNG_STREAM_LEVEL);
+        initBrickField(&batch->bricks[env], MAX_ROWS, MAX_COLS);
+        resetEnv(batch, env);
+        batch->reward[env] = 0;
+        batch->done[env] = 0;
+    }
+    return true;
+}
+
+void unloadEnvBatch(EnvBatch *batch)
+{
+    memFree(batch->bricks);
+    batch->bricks = 0;
+    batch->count = 0;
+}
+
+// Starts a fresh round with the same generation rules as a new game level
+void resetEnv(EnvBatch *batch, int env)
+{
+    initBricks(&batch->bricks[env], batch->level, batch->screenWidth, &batch->rng[env]);
+    batch->lives[env] = 3;
+    batch->score[env] = 0;
+    batch->paddleX[env] = batch->screenWidth / 2;
+    serveEnv(batch, env);
+    writeObservation(batch, env);
+}
+
+// Full per-environment physics, the same calls stepGame makes in PLAY
+static void stepContact(EnvBatch *batch, int env)
+{
+    Ball ball = {batch->ballX[env], batch->ballY[env], batch->ballSpeedX[env], batch->ballSpeedY[env], ballRadius};
+    Paddle paddle = {batch->paddleX[env], paddleY(batch), PAD_SPEED, paddleWidth, paddleHeight};
+    BrickHit hits[MAX_BRICK_HITS];
+    int hitCount = 0;
+    paddleCollision(&ball, &paddle);
+    updateBall(&ball, &paddle, &batch->bricks[env], batch->screenWidth, batch->dt, &batch->score[env], hits, &hitCount);
+    batch->ballX[env] = ball.x;
+    batch->ballY[env] = ball.y;
+    batch->ballSpeedX[env] = ball.speedX;
+    batch->ballSpeedY[env] = ball.speedY;
+}
+
+// Paddles, then every ball whose swept bounds stay clear of the walls, the
+// paddle and the brick rows. Both loops are branch-free so they vectorise;
+// a free ball moves exactly as updateBall would move it. The arrays are only
+// touched through these parameters while it runs, which is what makes the
+// restrict qualifiers hold.
+static void moveFree(int count, float dt, float width, float brickTop, float brickBottom, float paddleTop, const signed char *restrict actions, float *restrict paddleX, float *restrict ballX, float *restrict ballY, const float *restrict speedX, const float *restrict speedY, unsigned char *restrict moving)
+{
+    const float step = PAD_SPEED * dt;
+    for (int env = 0; env < count; env++)
+    {
+        float x = paddleX[env] + actions[env] * step;
+        x = x < paddleWidth / 2 ? paddleWidth / 2 : x;
+        paddleX[env] = x > width - paddleWidth / 2 ? width - paddleWidth / 2 : x;
+    }
+    for (int env = 0; env < count; env++)
+    {
+        float dx = speedX[env] * dt;
+        float dy = speedY[env] * dt;
+        int free = isFreeFlight(ballX[env] + dx, ballY[env], ballY[env] + dy, ballRadius, width, brickTop, brickBottom, paddleTop);
+        // Adding 1 * d gives the same bits as adding d
+        float blend = (float)free;
+        ballX[env] += blend * dx;
+        ballY[env] += blend * dy;
+        moving[env] = !free;
+    }
+}
+
+void stepEnvBatch(EnvBatch *batch, const signed char *actions)
+{
+    const int count = batch->count;
+    // Brick rows share one layout across environments
+    const float brickTop = batch->bricks[0].top;
+    const float brickBottom = brickTop + batch->bricks[0].rows * BRICK_HEIGHT;
+    unsigned char *moving = batch->moving;
+    moveFree(count, batch->dt, batch->screenWidth, brickTop, brickBottom, paddleY(batch) - paddleHeight / 2, actions, batch->paddleX, batch->ballX, batch->ballY, batch->ballSpeedX, batch->ballSpeedY, moving);
+
+    for (int env = 0; env < count; env++)
+    {
+        int scoreBefore = batch->score[env];
+        if (moving[env])
+            stepContact(batch, env);
+        float reward = batch->score[env] - scoreBefore;
+        bool done = false;
+
+        if (batch->ballY[env] >= batch->screenHeight + SPRITE_SIZE)
+        {
+            reward -= ENV_FALL_PENALTY;
+            if (--batch->lives[env] <= 0)
+                done = true;
+            else
+                serveEnv(batch, env);
+        }
+        if (isLevelCleared(&batch->bricks[env]))
+        {
+            reward += (batch->level + 1) * 100;
+            done = true;
+        }
+
+        batch->reward[env] = reward;
+        batch->done[env] = done;
+        if (done)
+            resetEnv(batch, env);
+        else
+            writeObservation(batch, env);
+    }
+}
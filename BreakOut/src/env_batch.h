@@ -0,0 +1,61 @@
+#ifndef BREAKOUT_ENV_BATCH_H
+#define BREAKOUT_ENV_BATCH_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "bricks.h"
+#include "rng.h"
+#include "sim.h"
+
+#define ENV_FALL_PENALTY 10.0f
+
+// Observation slots, ENV_OBS_SIZE floats per environment
+enum EnvObs
+{
+    OBS_BALL_X,
+    OBS_BALL_Y,
+    OBS_BALL_SPEED_X,
+    OBS_BALL_SPEED_Y,
+    OBS_PADDLE_X,
+    OBS_BRICKS_LEFT,
+    OBS_LIVES,
+    ENV_OBS_SIZE
+};
+
+// Actions, one per environment per step
+#define ACTION_LEFT -1
+#define ACTION_STAY 0
+#define ACTION_RIGHT 1
+
+// N independent BreakOut rounds stepped together for bots. Every environment
+// is always in play: the ball launches on its own and a finished round (level
+// cleared or out of lives) flags done and restarts in the same step. Ball and
+// paddle state are parallel arrays across environments; each brick field keeps
+// its own bitboard. obs, reward and done are rewritten by every step and are
+// meant to be read in place.
+typedef struct EnvBatch
+{
+    int count;
+    int screenWidth, screenHeight;
+    int level;
+    float dt;
+    float *ballX, *ballY;
+    float *ballSpeedX, *ballSpeedY;
+    float *paddleX;
+    int *lives;
+    int *score;
+    unsigned char *moving;
+    BrickField *bricks;
+    Rng *rng;
+    float *obs;
+    float *reward;
+    unsigned char *done;
+} EnvBatch;
+
+bool initEnvBatch(EnvBatch *batch, int count, int screenWidth, int screenHeight, int level, uint64_t seed);
+void unloadEnvBatch(EnvBatch *batch);
+void resetEnv(EnvBatch *batch, int env);
+void stepEnvBatch(EnvBatch *batch, const signed char *actions);
+
+#endif
@@ -0,0 +1,19 @@
+#include "particle_render.h"
+
+void batchParticleSystem(SpriteBatch *batch, int layer, const ParticleSystem *particleSys)
+{
+    float size = particleSys->size;
+    unsigned int texture = rlGetTextureIdDefault();
+    for (int i = 0; i < particleSys->count; i++)
+    {
+        // Colors are premultiplied by alpha, no Fade() per particle
+        float alpha = particleSys->alpha[i];
+        ParticleColor color = particleSys->color[i];
+        Color tint = {color.r * alpha, color.g * alpha, color.b * alpha, color.a * alpha};
+
+        // Same integer snapping DrawRectangle applied
+        float x = (int)particleSys->x[i];
+        float y = (int)particleSys->y[i];
+        batchQuad(batch, layer, BLEND_ALPHA_PREMULTIPLY, texture, (Rectangle){x, y, size, size}, 0.0f, 0.0f, 0.0f, 0.0f, tint);
+    }
+}
@@ -0,0 +1,11 @@
+#ifndef BREAKOUT_PARTICLE_RENDER_H
+#define BREAKOUT_PARTICLE_RENDER_H
+
+#include "particles.h"
+#include "sprite_batch.h"
+
+// Every live particle as a premultiplied-alpha quad, so the whole pool lands
+// in one run of the sprite batch
+void batchParticleSystem(SpriteBatch *batch, int layer, const ParticleSystem *particleSys);
+
+#endif
@@ -0,0 +1,98 @@
+#include "particles.h"
+#include "memtrack.h"
+
+#include <stdlib.h>
+
+bool initParticleSystem(ParticleSystem *particleSys, int capacity, float size, float gravity, float fade, uint64_t seed)
+{
+    // Single block carved into the parallel arrays
+    size_t floats = (size_t)capacity * 4;
+    char *block = memAlloc(floats * sizeof(float) + (size_t)capacity * sizeof(ParticleColor), MEM_PARTICLES);
+    if (!block)
+    {
+        particleSys->capacity = 0;
+        particleSys->count = 0;
+        return false;
+    }
+    particleSys->x = (float *)block;
+    particleSys->y = particleSys->x + capacity;
+    particleSys->alpha = particleSys->y + capacity;
+    particleSys->jitter = particleSys->alpha + capacity;
+    particleSys->color = (ParticleColor *)(particleSys->jitter + capacity);
+    particleSys->count = 0;
+    particleSys->capacity = capacity;
+    particleSys->size = size;
+    particleSys->gravity = gravity;
+    particleSys->fade = fade;
+    rngSeed(&particleSys->rng, seed, RNG_STREAM_PARTICLES);
+    rngBatchSeed(&particleSys->jitterRng, seed, RNG_STREAM_PARTICLES);
+    return true;
+}
+
+void unloadParticleSystem(ParticleSystem *particleSys)
+{
+    memFree(particleSys->x);
+    particleSys->x = 0;
+    particleSys->count = 0;
+    particleSys->capacity = 0;
+}
+
+void clearParticleSystem(ParticleSystem *particleSys)
+{
+    particleSys->count = 0;
+}
+
+// Spawns a burst scattered over an area, returns how many fit in the pool
+int emitParticles(ParticleSystem *particleSys, float x, float y, float width, float height, ParticleColor color, int amount)
+{
+    int room = particleSys->capacity - particleSys->count;
+    if (amount > room)
+        amount = room;
+    for (int i = particleSys->count; i < particleSys->count + amount; i++)
+    {
+        particleSys->x[i] = rngRange(&particleSys->rng, x, x + width);
+        particleSys->y[i] = rngRange(&particleSys->rng, y, y + height);
+        particleSys->alpha[i] = 1.0f;
+        particleSys->color[i] = color;
+    }
+    particleSys->count += amount;
+    return amount;
+}
+
+void updateParticleSystem(ParticleSystem *particleSys, float dt)
+{
+    int count = particleSys->count;
+    float frames = dt * 60.0f;
+    float fall = particleSys->gravity * frames;
+    float fade = particleSys->fade * frames;
+
+    float *restrict jitter = particleSys->jitter;
+    rngFillRange(&particleSys->jitterRng, jitter, count, -3, 3, frames);
+
+    // Branch-free pass over contiguous arrays, left for the compiler to vectorize
+    float *restrict px = particleSys->x;
+    float *restrict py = particleSys->y;
+    float *restrict alpha = particleSys->alpha;
+    for (int i = 0; i < count; i++)
+    {
+        px[i] += jitter[i];
+        py[i] += fall;
+        alpha[i] -= fade;
+    }
+
+    // Swap-remove faded particles so only live ones are ever visited
+    for (int i = 0; i < count;)
+    {
+        if (alpha[i] > 0.0f)
+        {
+            i++;
+            continue;
+        }
+        count--;
+        px[i] = px[count];
+        py[i] = py[count];
+        alpha[i] = alpha[count];
+        particleSys->color[i] = particleSys->color[count];
+    }
+    particleSys->count = count;
+}
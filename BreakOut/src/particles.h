@@ -0,0 +1,43 @@
+#ifndef BREAKOUT_PARTICLES_H
+#define BREAKOUT_PARTICLES_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "rng.h"
+
+#define PARTICLE_CAPACITY 32768
+#define PARTICLES_PER_BURST 50
+
+// Same memory layout as raylib's Color
+typedef struct ParticleColor
+{
+    unsigned char r, g, b, a;
+} ParticleColor;
+
+// One pool for every live particle, stored as parallel arrays. Live particles
+// are always packed into [0, count), dead ones are swap-removed during update.
+// Rates are per 60 Hz frame and scaled by the elapsed time.
+typedef struct ParticleSystem
+{
+    float *x;
+    float *y;
+    float *alpha;
+    float *jitter;
+    ParticleColor *color;
+    int count;
+    int capacity;
+    float size;
+    float gravity;
+    float fade;
+    Rng rng;
+    RngBatch jitterRng;
+} ParticleSystem;
+
+bool initParticleSystem(ParticleSystem *particleSys, int capacity, float size, float gravity, float fade, uint64_t seed);
+void unloadParticleSystem(ParticleSystem *particleSys);
+int emitParticles(ParticleSystem *particleSys, float x, float y, float width, float height, ParticleColor color, int amount);
+void updateParticleSystem(ParticleSystem *particleSys, float dt);
+void clearParticleSystem(ParticleSystem *particleSys);
+
+#endif
@@ -0,0 +1,274 @@
+#include "replay.h"
+#include "memtrack.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const unsigned char replayMagic[4] = {'B', 'R', 'P', 'L'};
+
+// down bits in the low byte, pressed bits in the high byte
+uint16_t packInput(GameInput input)
+{
+    return (uint16_t)((input.down & 0xff) | ((input.pressed & 0xff) << 8));
+}
+
+GameInput unpackInput(uint16_t packed)
+{
+    return (GameInput){packed & 0xff, packed >> 8};
+}
+
+void initReplay(Replay *replay, uint64_t seed, int tickRate, int screenWidth, int screenHeight)
+{
+    replay->seed = seed;
+    replay->tickRate = tickRate;
+    replay->screenWidth = screenWidth;
+    replay->screenHeight = screenHeight;
+    replay->inputs = 0;
+    replay->tickCount = 0;
+    replay->capacity = 0;
+    replay->cursor = 0;
+    replay->finalHash = 0;
+}
+
+void unloadReplay(Replay *replay)
+{
+    memFree(replay->inputs);
+    replay->inputs = 0;
+    replay->tickCount = 0;
+    replay->capacity = 0;
+}
+
+bool recordReplayTick(Replay *replay, GameInput input)
+{
+    if (replay->tickCount == replay->capacity)
+    {
+        int capacity = replay->capacity ? replay->capacity * 2 : 4096;
+        uint16_t *inputs = memRealloc(replay->inputs, capacity * sizeof(uint16_t), MEM_SIM);
+        if (!inputs)
+            return false;
+        replay->inputs = inputs;
+        replay->capacity = capacity;
+    }
+    replay->inputs[replay->tickCount++] = packInput(input);
+    return true;
+}
+
+// Returns false once every recorded tick has been played
+bool nextReplayTick(Replay *replay, GameInput *input)
+{
+    if (replay->cursor >= replay->tickCount)
+        return false;
+    *input = unpackInput(replay->inputs[replay->cursor++]);
+    return true;
+}
+
+static void putU16(FILE *file, uint32_t value)
+{
+    fputc(value & 0xff, file);
+    fputc((value >> 8) & 0xff, file);
+}
+
+static void putU32(FILE *file, uint32_t value)
+{
+    putU16(file, value & 0xffff);
+    putU16(file, value >> 16);
+}
+
+static void putU64(FILE *file, uint64_t value)
+{
+    putU32(file, (uint32_t)value);
+    putU32(file, (uint32_t)(value >> 32));
+}
+
+static void putVarint(FILE *file, uint32_t value)
+{
+    while (value >= 0x80)
+    {
+        fputc((value & 0x7f) | 0x80, file);
+        value >>= 7;
+    }
+    fputc(value, file);
+}
+
+static bool getU16(FILE *file, uint32_t *value)
+{
+    int lo = fgetc(file);
+    int hi = fgetc(file);
+    if (lo == EOF || hi == EOF)
+        return false;
+    *value = (uint32_t)lo | ((uint32_t)hi << 8);
+    return true;
+}
+
+static bool getU32(FILE *file, uint32_t *value)
+{
+    uint32_t lo, hi;
+    if (!getU16(file, &lo) || !getU16(file, &hi))
+        return false;
+    *value = lo | (hi << 16);
+    return true;
+}
+
+static bool getU64(FILE *file, uint64_t *value)
+{
+    uint32_t lo, hi;
+    if (!getU32(file, &lo) || !getU32(file, &hi))
+        return false;
+    *value = lo | ((uint64_t)hi << 32);
+    return true;
+}
+
+static bool getVarint(FILE *file, uint32_t *value)
+{
+    *value = 0;
+    for (int shift = 0; shift < 35; shift += 7)
+    {
+        int byte = fgetc(file);
+        if (byte == EOF)
+            return false;
+        *value |= (uint32_t)(byte & 0x7f) << shift;
+        if (!(byte & 0x80))
+            return true;
+    }
+    return false;
+}
+
+// Layout, little endian:
+//   "BRPL" u16 version u16 tickRate u64 seed u16 width u16 height
+//   u32 tickCount u64 finalHash, then (u16 input, varint run) pairs
+bool saveReplay(const Replay *replay, const char *fileName)
+{
+    FILE *file = fopen(fileName, "wb");
+    if (!file)
+        return false;
+
+    fwrite(replayMagic, 1, sizeof(replayMagic), file);
+    putU16(file, REPLAY_VERSION);
+    putU16(file, replay->tickRate);
+    putU64(file, replay->seed);
+    putU16(file, replay->screenWidth);
+    putU16(file, replay->screenHeight);
+    putU32(file, replay->tickCount);
+    putU64(file, replay->finalHash);
+
+    for (int i = 0; i < replay->tickCount;)
+    {
+        uint16_t value = replay->inputs[i];
+        int run = 1;
+        while (i + run < replay->tickCount && replay->inputs[i + run] == value)
+            run++;
+        putU16(file, value);
+        putVarint(file, run);
+        i += run;
+    }
+
+    bool ok = !ferror(file);
+    return fclose(file) == 0 && ok;
+}
+
+bool loadReplay(Replay *replay, const char *fileName)
+{
+    FILE *file = fopen(fileName, "rb");
+    if (!file)
+        return false;
+
+    unsigned char magic[4];
+    uint32_t version, tickRate, width, height, tickCount;
+    uint64_t seed, finalHash;
+    bool ok = fread(magic, 1, sizeof(magic), file) == sizeof(magic) && memcmp(magic, replayMagic, sizeof(magic)) == 0;
+    ok = ok && getU16(file, &version) && version == REPLAY_VERSION;
+    ok = ok && getU16(file, &tickRate) && tickRate > 0 && tickRate <= SIM_MAX_TICK_RATE && getU64(file, &seed);
+    ok = ok && getU16(file, &width) && getU16(file, &height);
+    ok = ok && getU32(file, &tickCount) && getU64(file, &finalHash);
+    if (!ok)
+    {
+        fclose(file);
+        return false;
+    }
+
+    initReplay(replay, seed, tickRate, width, height);
+    replay->finalHash = finalHash;
+    replay->inputs = memAlloc((tickCount ? tickCount : 1) * sizeof(uint16_t), MEM_SIM);
+    replay->capacity = tickCount;
+    ok = replay->inputs != 0;
+    while (ok && replay->tickCount < (int)tickCount)
+    {
+        uint32_t value, run;
+        ok = getU16(file, &value) && getVarint(file, &run) && run <= tickCount - replay->tickCount;
+        for (uint32_t r = 0; ok && r < run; r++)
+            replay->inputs[replay->tickCount++] = (uint16_t)value;
+    }
+    fclose(file);
+    if (!ok)
+        unloadReplay(replay);
+    return ok;
+}
+
+// Fast-forward: rebuilds the session from the seed and steps every recorded
+// tick back to back, then returns the hash of the final state
+uint64_t runReplay(const Replay *replay, GameState *game)
+{
+    float dt = 1.0f / replay->tickRate;
+    initGameState(game, replay->screenWidth, replay->screenHeight, replay->seed);
+    for (int i = 0; i < replay->tickCount; i++)
+        stepGame(game, unpackInput(replay->inputs[i]), dt);
+    return hashGameState(game);
+}
+
+static uint64_t hashBytes(uint64_t hash, const void *data, size_t size)
+{
+    // FNV-1a
+    const unsigned char *bytes = data;
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= bytes[i];
+        hash *= 0x100000001B3ull;
+    }
+    return hash;
+}
+
+#define HASH_FIELD(hash, field) hashBytes(hash, &(field), sizeof(field))
+
+// Hash of everything that decides how the session continues. Per-step event
+// output is left out, and bricks are hashed over the used part of the grid.
+uint64_t hashGameState(const GameState *game)
+{
+    uint64_t hash = 0xCBF29CE484222325ull;
+    int state = game->state;
+    hash = HASH_FIELD(hash, state);
+    hash = HASH_FIELD(hash, game->level);
+    hash = HASH_FIELD(hash, game->lives);
+    hash = HASH_FIELD(hash, game->score);
+    hash = HASH_FIELD(hash, game->menuIndex);
+    hash = HASH_FIELD(hash, game->setting.paddle);
+    const BallSet *balls = &game->balls;
+    hash = HASH_FIELD(hash, balls->count);
+    hash = hashBytes(hash, balls->x, balls->count * sizeof(float));
+    hash = hashBytes(hash, balls->y, balls->count * sizeof(float));
+    hash = hashBytes(hash, balls->speedX, balls->count * sizeof(float));
+    hash = hashBytes(hash, balls->speedY, balls->count * sizeof(float));
+    hash = HASH_FIELD(hash, game->paddle.x);
+    hash = HASH_FIELD(hash, game->levelRng.s);
+    hash = HASH_FIELD(hash, game->gameRng.s);
+
+    const BrickField *bricks = &game->bricks;
+    hash = HASH_FIELD(hash, bricks->liveCount);
+    for (int i = 0; i < bricks->rows; i++)
+    {
+        hash = HASH_FIELD(hash, bricks->rowX[i]);
+        hash = HASH_FIELD(hash, bricks->live[i]);
+        hash = hashBytes(hash, &bricks->health[brickIndex(i, 0)], bricks->cols);
+        hash = hashBytes(hash, &bricks->tier[brickIndex(i, 0)], bricks->cols);
+    }
+    // Only once endless mode is picked, so classic hashes are unchanged
+    if (game->setting.mode != MODE_CLASSIC || game->endless)
+    {
+        hash = HASH_FIELD(hash, game->setting.mode);
+        hash = HASH_FIELD(hash, game->endless);
+        hash = HASH_FIELD(hash, game->endlessSeed);
+        hash = HASH_FIELD(hash, game->endlessRows);
+        hash = HASH_FIELD(hash, bricks->top);
+    }
+    return hash;
+}
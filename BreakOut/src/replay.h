@@ -0,0 +1,37 @@
+#ifndef BREAKOUT_REPLAY_H
+#define BREAKOUT_REPLAY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "sim.h"
+
+#define REPLAY_VERSION 2
+
+// Seed plus the exact input fed to every simulation tick. Held in memory as one
+// packed word per tick; on disk the words are run-length encoded.
+typedef struct Replay
+{
+    uint64_t seed;
+    int tickRate;
+    int screenWidth, screenHeight;
+    uint16_t *inputs;
+    int tickCount;
+    int capacity;
+    int cursor;
+    uint64_t finalHash;
+} Replay;
+
+void initReplay(Replay *replay, uint64_t seed, int tickRate, int screenWidth, int screenHeight);
+void unloadReplay(Replay *replay);
+bool recordReplayTick(Replay *replay, GameInput input);
+bool nextReplayTick(Replay *replay, GameInput *input);
+bool saveReplay(const Replay *replay, const char *fileName);
+bool loadReplay(Replay *replay, const char *fileName);
+uint64_t runReplay(const Replay *replay, GameState *game);
+
+uint16_t packInput(GameInput input);
+GameInput unpackInput(uint16_t packed);
+uint64_t hashGameState(const GameState *game);
+
+#endif
@@ -0,0 +1,95 @@
+#include "rng.h"
+
+static uint64_t splitMix64(uint64_t *state)
+{
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+static inline uint32_t rotl(uint32_t x, int k)
+{
+    return (x << k) | (x >> (32 - k));
+}
+
+// Seeds are expanded with SplitMix64 from (seed, stream), so every stream of
+// the same seed starts from an unrelated, never all-zero state
+void rngSeed(Rng *rng, uint64_t seed, uint64_t stream)
+{
+    uint64_t state = seed ^ (stream * 0xD1B54A32D192ED03ull);
+    uint64_t a = splitMix64(&state);
+    uint64_t b = splitMix64(&state);
+    rng->s[0] = (uint32_t)a;
+    rng->s[1] = (uint32_t)(a >> 32);
+    rng->s[2] = (uint32_t)b;
+    rng->s[3] = (uint32_t)(b >> 32);
+}
+
+uint32_t rngNext(Rng *rng)
+{
+    uint32_t *s = rng->s;
+    uint32_t result = rotl(s[1] * 5, 7) * 9;
+    uint32_t t = s[1] << 9;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotl(s[3], 11);
+    return result;
+}
+
+// Uniform integer in [min, max]
+int rngRange(Rng *rng, int min, int max)
+{
+    uint64_t span = (uint64_t)((int64_t)max - min + 1);
+    return min + (int)(((uint64_t)rngNext(rng) * span) >> 32);
+}
+
+// Uniform float in [0, 1)
+float rngFloat(Rng *rng)
+{
+    return (rngNext(rng) >> 8) * (1.0f / 16777216.0f);
+}
+
+void rngBatchSeed(RngBatch *batch, uint64_t seed, uint64_t stream)
+{
+    for (int lane = 0; lane < RNG_LANES; lane++)
+    {
+        Rng rng;
+        rngSeed(&rng, seed, stream * RNG_LANES + lane);
+        for (int k = 0; k < 4; k++)
+            batch->s[k][lane] = rng.s[k];
+    }
+}
+
+// Fills out[] with integers in [min, max] times scale. Each round advances all
+// lanes at once, which the compiler turns into vector code.
+void rngFillRange(RngBatch *batch, float *out, int count, int min, int max, float scale)
+{
+    uint64_t span = (uint64_t)((int64_t)max - min + 1);
+    uint32_t *s0 = batch->s[0];
+    uint32_t *s1 = batch->s[1];
+    uint32_t *s2 = batch->s[2];
+    uint32_t *s3 = batch->s[3];
+
+    for (int i = 0; i < count; i += RNG_LANES)
+    {
+        uint32_t result[RNG_LANES];
+        for (int lane = 0; lane < RNG_LANES; lane++)
+        {
+            result[lane] = rotl(s1[lane] * 5, 7) * 9;
+            uint32_t t = s1[lane] << 9;
+            s2[lane] ^= s0[lane];
+            s3[lane] ^= s1[lane];
+            s1[lane] ^= s2[lane];
+            s0[lane] ^= s3[lane];
+            s2[lane] ^= t;
+            s3[lane] = rotl(s3[lane], 11);
+        }
+        int n = count - i < RNG_LANES ? count - i : RNG_LANES;
+        for (int lane = 0; lane < n; lane++)
+            out[i + lane] = (float)(min + (int)(((uint64_t)result[lane] * span) >> 32)) * scale;
+    }
+}
@@ -0,0 +1,35 @@
+#ifndef BREAKOUT_RNG_H
+#define BREAKOUT_RNG_H
+
+#include <stdint.h>
+
+#define RNG_LANES 8
+
+// Independent streams, one per subsystem, so one can't perturb another
+#define RNG_STREAM_LEVEL 1
+#define RNG_STREAM_PARTICLES 2
+#define RNG_STREAM_GAMEPLAY 3
+// Endless-mode chunks, one stream per chunk index above this
+#define RNG_STREAM_ENDLESS 4
+
+// xoshiro128** generator
+typedef struct Rng
+{
+    uint32_t s[4];
+} Rng;
+
+// RNG_LANES xoshiro128** generators side by side, for filling buffers
+typedef struct RngBatch
+{
+    uint32_t s[4][RNG_LANES];
+} RngBatch;
+
+void rngSeed(Rng *rng, uint64_t seed, uint64_t stream);
+uint32_t rngNext(Rng *rng);
+int rngRange(Rng *rng, int min, int max);
+float rngFloat(Rng *rng);
+
+void rngBatchSeed(RngBatch *batch, uint64_t seed, uint64_t stream);
+void rngFillRange(RngBatch *batch, float *out, int count, int min, int max, float scale);
+
+#endif
@@ -0,0 +1,348 @@
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200112L
+#endif
+
+#include "score_store.h"
+#include "byte_stream.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <io.h>
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+static const unsigned char indexMagic[4] = {'B', 'R', 'S', 'I'};
+
+// Log record: score, level, paddle, time, sequence number, CRC of the rest.
+// The sequence number is the record's position in the log, so a stale record
+// left behind a torn write is rejected as well as a corrupt one.
+#define RECORD_SIZE 28
+#define RECORD_CRC_OFFSET 24
+
+#define ENTRY_SIZE 20
+#define HISTORY_SIZE (8 + 8 + 4 + 4 + 4 + SCORE_HISTORY * 4)
+#define INDEX_MAX_SIZE (4 + 2 + 2 + 8 + 4 + SCORE_TOP_K * ENTRY_SIZE + PADDLE_TOTAL * HISTORY_SIZE + 4)
+
+static uint32_t crc32(const unsigned char *data, size_t size)
+{
+    static uint32_t table[256];
+    if (!table[1])
+    {
+        for (uint32_t i = 0; i < 256; i++)
+        {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++)
+                c = c & 1 ? 0xedb88320u ^ (c >> 1) : c >> 1;
+            table[i] = c;
+        }
+    }
+    uint32_t crc = 0xffffffffu;
+    for (size_t i = 0; i < size; i++)
+        crc = table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+    return crc ^ 0xffffffffu;
+}
+
+static bool syncFile(FILE *file)
+{
+    if (fflush(file) != 0)
+        return false;
+#if defined(_WIN32)
+    return _commit(_fileno(file)) == 0;
+#else
+    return fsync(fileno(file)) == 0;
+#endif
+}
+
+static bool replaceFile(const char *from, const char *to)
+{
+#if defined(_WIN32)
+    return MoveFileExA(from, to, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+    return rename(from, to) == 0;
+#endif
+}
+
+static void siftDown(ScoreEntry *heap, int count, int i)
+{
+    for (;;)
+    {
+        int smallest = i;
+        int left = 2 * i + 1;
+        int right = left + 1;
+        if (left < count && heap[left].score < heap[smallest].score)
+            smallest = left;
+        if (right < count && heap[right].score < heap[smallest].score)
+            smallest = right;
+        if (smallest == i)
+            return;
+        ScoreEntry swap = heap[i];
+        heap[i] = heap[smallest];
+        heap[smallest] = swap;
+        i = smallest;
+    }
+}
+
+static void siftUp(ScoreEntry *heap, int i)
+{
+    while (i > 0 && heap[(i - 1) / 2].score > heap[i].score)
+    {
+        ScoreEntry swap = heap[i];
+        heap[i] = heap[(i - 1) / 2];
+        heap[(i - 1) / 2] = swap;
+        i = (i - 1) / 2;
+    }
+}
+
+static void applyEntry(ScoreStore *store, ScoreEntry entry)
+{
+    if (store->topCount < SCORE_TOP_K)
+    {
+        store->top[store->topCount] = entry;
+        siftUp(store->top, store->topCount++);
+    }
+    else if (entry.score > store->top[0].score)
+    {
+        store->top[0] = entry;
+        siftDown(store->top, store->topCount, 0);
+    }
+
+    if (entry.paddle >= 0 && entry.paddle < PADDLE_TOTAL)
+    {
+        PaddleHistory *history = &store->paddles[entry.paddle];
+        if (history->games == 0 || entry.score > history->best)
+            history->best = entry.score;
+        history->games++;
+        history->totalScore += entry.score;
+        history->recent[history->recentNext] = entry.score;
+        history->recentNext = (history->recentNext + 1) % SCORE_HISTORY;
+        if (history->recentCount < SCORE_HISTORY)
+            history->recentCount++;
+    }
+}
+
+static void putEntry(ByteStream *out, const ScoreEntry *entry)
+{
+    putU32(out, (uint32_t)entry->score);
+    putU32(out, (uint32_t)entry->level);
+    putU32(out, (uint32_t)entry->paddle);
+    putU64(out, (uint64_t)entry->time);
+}
+
+static ScoreEntry getEntry(ByteStream *in)
+{
+    ScoreEntry entry;
+    entry.score = (int32_t)getU32(in);
+    entry.level = (int32_t)getU32(in);
+    entry.paddle = (int32_t)getU32(in);
+    entry.time = (int64_t)getU64(in);
+    return entry;
+}
+
+static bool writeIndex(const ScoreStore *store)
+{
+    unsigned char buffer[INDEX_MAX_SIZE];
+    ByteStream out = {buffer, 0, sizeof(buffer), 0, false};
+    putBytes(&out, indexMagic, 4);
+    putU16(&out, SCORE_STORE_VERSION);
+    putU16(&out, SCORE_TOP_K);
+    putU64(&out, (uint64_t)store->records);
+    putU32(&out, (uint32_t)store->topCount);
+    for (int i = 0; i < store->topCount; i++)
+        putEntry(&out, &store->top[i]);
+    for (int p = 0; p < PADDLE_TOTAL; p++)
+    {
+        const PaddleHistory *history = &store->paddles[p];
+        putU64(&out, (uint64_t)history->games);
+        putU64(&out, (uint64_t)history->totalScore);
+        putU32(&out, (uint32_t)history->best);
+        putU32(&out, (uint32_t)history->recentCount);
+        putU32(&out, (uint32_t)history->recentNext);
+        for (int i = 0; i < SCORE_HISTORY; i++)
+            putU32(&out, (uint32_t)history->recent[i]);
+    }
+    putU32(&out, crc32(buffer, out.position));
+    if (out.failed)
+        return false;
+
+    char tempPath[SCORE_PATH_MAX + 4];
+    snprintf(tempPath, sizeof(tempPath), "%s.tmp", store->indexPath);
+    FILE *file = fopen(tempPath, "wb");
+    if (!file)
+        return false;
+    bool ok = fwrite(buffer, 1, out.position, file) == out.position;
+    ok = syncFile(file) && ok;
+    ok = fclose(file) == 0 && ok;
+    if (ok)
+        ok = replaceFile(tempPath, store->indexPath);
+    if (!ok)
+        remove(tempPath);
+    return ok;
+}
+
+static bool readIndex(ScoreStore *store)
+{
+    FILE *file = fopen(store->indexPath, "rb");
+    if (!file)
+        return false;
+    unsigned char buffer[INDEX_MAX_SIZE + 1];
+    size_t size = fread(buffer, 1, sizeof(buffer), file);
+    fclose(file);
+    if (size < 8 || size > INDEX_MAX_SIZE)
+        return false;
+
+    ByteStream in = {0, buffer, size - 4, 0, false};
+    ByteStream tail = {0, buffer + size - 4, 4, 0, false};
+    unsigned char magic[4];
+    getBytes(&in, magic, 4);
+    if (memcmp(magic, indexMagic, 4) != 0 || getU16(&in) != SCORE_STORE_VERSION || getU16(&in) != SCORE_TOP_K)
+        return false;
+    if (getU32(&tail) != crc32(buffer, size - 4))
+        return false;
+
+    ScoreStore loaded = *store;
+    loaded.records = (int64_t)getU64(&in);
+    loaded.topCount = (int)getU32(&in);
+    if (loaded.records < 0 || loaded.topCount < 0 || loaded.topCount > SCORE_TOP_K)
+        return false;
+    for (int i = 0; i < loaded.topCount; i++)
+        loaded.top[i] = getEntry(&in);
+    for (int p = 0; p < PADDLE_TOTAL; p++)
+    {
+        PaddleHistory *history = &loaded.paddles[p];
+        history->games = (int64_t)getU64(&in);
+        history->totalScore = (int64_t)getU64(&in);
+        history->best = (int32_t)getU32(&in);
+        history->recentCount = (int)getU32(&in);
+        history->recentNext = (int)getU32(&in);
+        for (int i = 0; i < SCORE_HISTORY; i++)
+            history->recent[i] = (int32_t)getU32(&in);
+        if (history->recentCount < 0 || history->recentCount > SCORE_HISTORY || history->recentNext < 0 || history->recentNext >= SCORE_HISTORY)
+            return false;
+    }
+    if (in.failed || in.position != in.size)
+        return false;
+    *store = loaded;
+    return true;
+}
+
+static void encodeRecord(unsigned char *record, const ScoreEntry *entry, int64_t sequence)
+{
+    ByteStream out = {record, 0, RECORD_SIZE, 0, false};
+    putEntry(&out, entry);
+    putU32(&out, (uint32_t)sequence);
+    putU32(&out, crc32(record, RECORD_CRC_OFFSET));
+}
+
+static bool decodeRecord(const unsigned char *record, ScoreEntry *entry, int64_t sequence)
+{
+    ByteStream in = {0, record, RECORD_SIZE, 0, false};
+    *entry = getEntry(&in);
+    uint32_t storedSequence = getU32(&in);
+    return storedSequence == (uint32_t)sequence && getU32(&in) == crc32(record, RECORD_CRC_OFFSET);
+}
+
+// Applies the log records from store->records on. Returns the number applied,
+// or -1 if the log holds fewer records than the index claims.
+static int64_t replayLog(ScoreStore *store)
+{
+    FILE *file = fopen(store->logPath, "rb");
+    if (!file)
+        return store->records ? -1 : 0;
+    unsigned char record[RECORD_SIZE];
+    int64_t applied = 0;
+    if (fseek(file, (long)(store->records * RECORD_SIZE), SEEK_SET) != 0 ||
+        (store->records && (fseek(file, -RECORD_SIZE, SEEK_CUR) != 0 || fread(record, 1, RECORD_SIZE, file) != RECORD_SIZE)))
+    {
+        fclose(file);
+        return -1;
+    }
+    ScoreEntry entry;
+    while (fread(record, 1, RECORD_SIZE, file) == RECORD_SIZE && decodeRecord(record, &entry, store->records))
+    {
+        applyEntry(store, entry);
+        store->records++;
+        applied++;
+    }
+    fclose(file);
+    return applied;
+}
+
+bool openScoreStore(ScoreStore *store, const char *basePath)
+{
+    memset(store, 0, sizeof(*store));
+    int logLength = snprintf(store->logPath, SCORE_PATH_MAX, "%s.log", basePath);
+    int indexLength = snprintf(store->indexPath, SCORE_PATH_MAX, "%s.idx", basePath);
+    if (logLength < 0 || logLength >= SCORE_PATH_MAX || indexLength < 0 || indexLength >= SCORE_PATH_MAX)
+        return false;
+
+    bool indexed = readIndex(store);
+    int64_t applied = replayLog(store);
+    if (applied < 0)
+    {
+        // The index is ahead of the log, so rebuild from the log alone
+        memset(store->top, 0, sizeof(store->top));
+        memset(store->paddles, 0, sizeof(store->paddles));
+        store->topCount = 0;
+        store->records = 0;
+        applied = replayLog(store);
+        indexed = false;
+    }
+    if (applied > 0 || (!indexed && store->records))
+        writeIndex(store);
+    return true;
+}
+
+bool recordScore(ScoreStore *store, ScoreEntry entry)
+{
+    unsigned char record[RECORD_SIZE];
+    encodeRecord(record, &entry, store->records);
+
+    // Write over whatever follows the last valid record, so a torn tail from
+    // an earlier crash is replaced rather than left in the middle of the log
+    FILE *file = fopen(store->logPath, "r+b");
+    if (!file)
+        file = fopen(store->logPath, "w+b");
+    bool ok = file != 0;
+    if (ok)
+    {
+        ok = fseek(file, (long)(store->records * RECORD_SIZE), SEEK_SET) == 0 && fwrite(record, 1, RECORD_SIZE, file) == RECORD_SIZE;
+        ok = syncFile(file) && ok;
+        ok = fclose(file) == 0 && ok;
+    }
+
+    if (!ok)
+        return false;
+    applyEntry(store, entry);
+    store->records++;
+    // A failed index write costs only load time: the log replays past it
+    writeIndex(store);
+    return true;
+}
+
+int topScores(const ScoreStore *store, ScoreEntry *out, int max)
+{
+    // Popping the min-heap yields the lowest first, so fill from the back
+    ScoreEntry heap[SCORE_TOP_K];
+    ScoreEntry sorted[SCORE_TOP_K];
+    int count = store->topCount;
+    memcpy(heap, store->top, sizeof(ScoreEntry) * count);
+    for (int i = count - 1; i >= 0; i--)
+    {
+        sorted[i] = heap[0];
+        heap[0] = heap[i];
+        siftDown(heap, i, 0);
+    }
+    int written = count < max ? count : max;
+    memcpy(out, sorted, sizeof(ScoreEntry) * written);
+    return written;
+}
+
+bool isHighScore(const ScoreStore *store, int score)
+{
+    return store->topCount < SCORE_TOP_K || score > store->top[0].score;
+}
@@ -0,0 +1,59 @@
+#ifndef BREAKOUT_SCORE_STORE_H
+#define BREAKOUT_SCORE_STORE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "sim.h"
+
+#define SCORE_STORE_VERSION 1
+#define SCORE_TOP_K 10
+#define SCORE_HISTORY 8
+#define SCORE_PATH_MAX 256
+
+typedef struct ScoreEntry
+{
+    int32_t score;
+    int32_t level;
+    int32_t paddle;
+    int64_t time;
+} ScoreEntry;
+
+// Running totals and the most recent results for one paddle
+typedef struct PaddleHistory
+{
+    int64_t games;
+    int64_t totalScore;
+    int32_t best;
+    int32_t recent[SCORE_HISTORY];
+    int recentCount;
+    int recentNext;
+} PaddleHistory;
+
+// High scores kept as an append-only log of CRC-checked records plus an index
+// holding the top scores and per-paddle history. The log is the source of
+// truth; the index is replaced atomically after every append and records how
+// much of the log it covers, so opening the store reads the index and only the
+// log records written after it. A torn or corrupt tail record is dropped and
+// overwritten by the next append.
+typedef struct ScoreStore
+{
+    char logPath[SCORE_PATH_MAX];
+    char indexPath[SCORE_PATH_MAX];
+    ScoreEntry top[SCORE_TOP_K]; // min-heap on score
+    int topCount;
+    PaddleHistory paddles[PADDLE_TOTAL];
+    int64_t records;
+} ScoreStore;
+
+// Opens <basePath>.log and <basePath>.idx, creating nothing until the first
+// score is recorded. Returns false when the paths do not fit.
+bool openScoreStore(ScoreStore *store, const char *basePath);
+// Appends the score to the log, then rewrites the index. Returns false and
+// leaves the store unchanged if the record could not be made durable.
+bool recordScore(ScoreStore *store, ScoreEntry entry);
+// Copies up to max of the best scores, highest first
+int topScores(const ScoreStore *store, ScoreEntry *out, int max);
+bool isHighScore(const ScoreStore *store, int score);
+
+#endif
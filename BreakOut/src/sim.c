@@ -0,0 +1,674 @@
+#include "sim.h"
+#include "profiler.h"
+#include "replay.h"
+
+#include <math.h>
+#include <string.h>
+
+enum Contact
+{
+    CONTACT_NONE,
+    CONTACT_WALL,
+    CONTACT_CEILING,
+    CONTACT_PADDLE,
+    CONTACT_BRICK
+};
+
+static bool circleRectOverlap(float cx, float cy, float radius, float rx, float ry, float width, float height);
+static bool sweepCircleRect(float x, float y, float dx, float dy, float radius, float cx, float cy, float halfW, float halfH, float *toi, float *nx, float *ny);
+static void bounceOffPaddle(Ball *ball, const Paddle *paddle);
+
+void initGameState(GameState *game, int screenWidth, int screenHeight, uint64_t seed)
+{
+    game->state = MENU;
+    game->screenWidth = screenWidth;
+    game->screenHeight = screenHeight;
+    game->level = 4;
+    game->lives = 3;
+    game->score = 0;
+    game->menuIndex = 0;
+    game->setting = (Setting){0, 0, MODE_CLASSIC};
+    rngSeed(&game->levelRng, seed, RNG_STREAM_LEVEL);
+    rngSeed(&game->gameRng, seed, RNG_STREAM_GAMEPLAY);
+    game->events = 0;
+    game->hitCount = 0;
+    game->endless = false;
+    game->endlessSeed = 0;
+    game->endlessRows = 0;
+    memset(&game->chunk, 0, sizeof(game->chunk));
+    game->chunkStream = 0;
+
+    BallSet *balls = &game->balls;
+    balls->count = 1;
+    balls->radius = SPRITE_SIZE / 2;
+    balls->x[0] = balls->prevX[0] = screenWidth / 2;
+    balls->y[0] = balls->prevY[0] = screenHeight - 150;
+    balls->speedX[0] = 0;
+    balls->speedY[0] = 0;
+
+    game->paddle.x = screenWidth / 2;
+    game->paddle.y = screenHeight - 80;
+    game->paddle.speed = PAD_SPEED;
+    game->paddle.width = SPRITE_SIZE * 3;
+    game->paddle.height = SPRITE_SIZE;
+
+    game->prevPaddleX = game->paddle.x;
+
+    initBrickField(&game->bricks, MAX_ROWS, MAX_COLS);
+    initBricks(&game->bricks, game->level, game->screenWidth, &game->levelRng);
+}
+
+static void startRound(GameState *game)
+{
+    if (game->setting.mode == MODE_ENDLESS)
+        startEndless(game);
+    else
+    {
+        // Back from an endless run to the classic field
+        if (game->endless)
+        {
+            game->endless = false;
+            initBrickField(&game->bricks, MAX_ROWS, MAX_COLS);
+        }
+        initBricks(&game->bricks, game->level, game->screenWidth, &game->levelRng);
+    }
+    serveBall(&game->balls, &game->paddle);
+    game->state = PLAY;
+}
+
+static bool switchMenu(GameState *game, GameInput input)
+{
+    if (input.pressed & (INPUT_UP | INPUT_DOWN))
+    {
+        game->menuIndex = !game->menuIndex;
+        return true;
+    }
+    return false;
+}
+
+void stepGame(GameState *game, GameInput input, float dt)
+{
+    BallSet *balls = &game->balls;
+    Paddle *paddle = &game->paddle;
+
+    game->events = 0;
+    game->hitCount = 0;
+    memcpy(balls->prevX, balls->x, balls->count * sizeof(float));
+    memcpy(balls->prevY, balls->y, balls->count * sizeof(float));
+    game->prevPaddleX = paddle->x;
+
+    // Menu Screen
+    if (game->state == MENU)
+    {
+        if (switchMenu(game, input))
+            game->events |= EVENT_SELECT;
+        // Switch to Setting Screen
+        if (input.pressed & INPUT_ENTER)
+        {
+            game->events |= EVENT_SELECT;
+            if (game->menuIndex == 0)
+                game->state = SETTING;
+            else
+                game->state = SCOREBOARD;
+        }
+    }
+    // Paddle Select State
+    else if (game->state == SETTING)
+    {
+        if (input.pressed & INPUT_RIGHT)
+        {
+            if (game->setting.paddle < PADDLE_TOTAL - 1)
+            {
+                game->setting.paddle++;
+                game->events |= EVENT_SELECT;
+            }
+            else
+                game->events |= EVENT_DISABLE;
+        }
+
+        if (input.pressed & INPUT_LEFT)
+        {
+            if (game->setting.paddle > 0)
+            {
+                game->setting.paddle--;
+                game->events |= EVENT_SELECT;
+            }
+            else
+                game->events |= EVENT_DISABLE;
+        }
+
+        if (input.pressed & (INPUT_UP | INPUT_DOWN))
+        {
+            game->setting.mode = game->setting.mode == MODE_ENDLESS ? MODE_CLASSIC : MODE_ENDLESS;
+            game->events |= EVENT_SELECT;
+        }
+
+        if (input.pressed & INPUT_ENTER)
+        {
+            game->events |= EVENT_SELECT;
+            startRound(game);
+        }
+    }
+    // Gameover state
+    else if (game->state == GAMEOVER)
+    {
+        if (switchMenu(game, input))
+            game->events |= EVENT_SELECT;
+        if (input.pressed & INPUT_ENTER)
+        {
+            game->events |= EVENT_SELECT;
+            if (game->menuIndex == 1)
+                game->state = MENU;
+            else
+            {
+                game->lives = 3;
+                game->score = 0;
+                game->level = 1;
+                startRound(game);
+            }
+        }
+    }
+    // Victory State
+    else if (game->state == VICTORY)
+    {
+        if (switchMenu(game, input))
+            game->events |= EVENT_SELECT;
+        if (input.pressed & INPUT_ENTER)
+        {
+            game->events |= EVENT_SELECT;
+            if (game->menuIndex == 1)
+                game->state = SCOREBOARD;
+            else
+                startRound(game);
+        }
+    }
+    else if (game->state == SCOREBOARD)
+    {
+        if (input.pressed & INPUT_ENTER)
+        {
+            game->events |= EVENT_SELECT;
+            game->state = MENU;
+        }
+    }
+    // Play State
+    else if (game->state == PLAY)
+    {
+        if (input.pressed & INPUT_SPACE)
+        {
+            if (isBallServed(balls))
+            {
+                game->events |= EVENT_SELECT;
+                balls->speedX[0] = BALL_SPEED;
+                balls->speedY[0] = BALL_SPEED;
+            }
+            else
+            {
+                game->events |= EVENT_PAUSE;
+                game->state = PAUSED;
+            }
+        }
+
+        if (isBallServed(balls))
+            serveBall(balls, paddle);
+        paddleControl(paddle, input, game->screenWidth, dt);
+
+        PROFILE_BEGIN(PHASE_COLLISION);
+        game->events |= updateBalls(balls, paddle, &game->bricks, game->screenWidth, game->screenHeight, dt, &game->gameRng, &game->score, game->hits, &game->hitCount);
+        PROFILE_END(PHASE_COLLISION);
+
+        // A life is only lost once the last ball is gone
+        if (balls->count == 0)
+        {
+            game->events |= EVENT_FALL;
+            game->lives--;
+            if (game->lives <= 0)
+                game->state = GAMEOVER;
+            else
+                serveBall(balls, paddle);
+        }
+        // An endless run has no last brick, only rows that get away. Once
+        // the last life is gone the field stops moving.
+        if (game->endless)
+        {
+            if (game->state == PLAY)
+                game->events |= scrollEndless(game, dt);
+            if (game->lives <= 0)
+                game->state = GAMEOVER;
+        }
+        else if (isLevelCleared(&game->bricks))
+        {
+            game->state = VICTORY;
+            game->level++;
+            game->score += (game->level * 100);
+            game->events |= EVENT_VICTORY;
+        }
+    }
+    else if (game->state == PAUSED)
+    {
+        if (input.pressed & INPUT_SPACE)
+        {
+            game->events |= EVENT_PAUSE;
+            game->state = PLAY;
+        }
+    }
+}
+
+void initFixedStep(FixedStep *clock, int tickRate)
+{
+    clock->tickRate = tickRate > 0 && tickRate <= SIM_MAX_TICK_RATE ? tickRate : SIM_TICK_RATE;
+    clock->tickDt = 1.0f / clock->tickRate;
+    clock->accumulator = 0;
+    clock->pendingPressed = 0;
+    clock->events = 0;
+    clock->hitCount = 0;
+    clock->playback = 0;
+    clock->recording = 0;
+}
+
+// Runs as many fixed ticks as the elapsed frame time allows. Key presses are
+// latched until a tick consumes them, so a press is never lost on a frame that
+// runs no ticks and never repeated on a frame that runs several.
+int advanceFixedStep(FixedStep *clock, GameState *game, GameInput input, float frameTime)
+{
+    if (frameTime > SIM_MAX_FRAME_TIME)
+        frameTime = SIM_MAX_FRAME_TIME;
+    clock->accumulator += frameTime;
+    clock->pendingPressed |= input.pressed;
+    clock->events = 0;
+    clock->hitCount = 0;
+
+    int ticks = 0;
+    while (clock->accumulator >= clock->tickDt)
+    {
+        GameInput tickInput = {input.down, clock->pendingPressed};
+        clock->pendingPressed = 0;
+        if (clock->playback && !nextReplayTick(clock->playback, &tickInput))
+            clock->playback = 0;
+        if (clock->recording)
+            recordReplayTick(clock->recording, tickInput);
+        stepGame(game, tickInput, clock->tickDt);
+        clock->accumulator -= clock->tickDt;
+        ticks++;
+
+        clock->events |= game->events;
+        for (int h = 0; h < game->hitCount && clock->hitCount < MAX_BRICK_HITS; h++)
+            clock->hits[clock->hitCount++] = game->hits[h];
+    }
+    return ticks;
+}
+
+// Fraction of a tick left in the accumulator, used to blend the last two states
+float fixedStepAlpha(const FixedStep *clock)
+{
+    return clock->accumulator / clock->tickDt;
+}
+
+void paddleControl(Paddle *paddle, GameInput input, int screenWidth, float dt)
+{
+    if (input.down & INPUT_RIGHT)
+    {
+        paddle->x += paddle->speed * dt;
+    }
+    else if (input.down & INPUT_LEFT)
+    {
+        paddle->x -= paddle->speed * dt;
+    }
+    if (paddle->x < paddle->width / 2)
+        paddle->x = paddle->width / 2;
+    else if (paddle->x > screenWidth - paddle->width / 2)
+        paddle->x = screenWidth - paddle->width / 2;
+}
+
+// Moves the ball through one step, resolving every contact along the way in
+// time order. Each pass sweeps the remaining motion against the walls, the
+// paddle and the live bricks, advances to the earliest time of impact,
+// reflects off the contact normal and continues with what is left of dt.
+unsigned int updateBall(Ball *ball, Paddle *paddle, BrickField *bricks, int screenWidth, float dt, int *score, BrickHit hits[], int *hitCount)
+{
+    unsigned int events = 0;
+    float remaining = 1.0f;
+
+    for (int contact = 0; contact < MAX_BALL_CONTACTS && remaining > 0; contact++)
+    {
+        float dx = ball->speedX * dt * remaining;
+        float dy = ball->speedY * dt * remaining;
+        float toi = 1.0f;
+        float nx = 0, ny = 0;
+        enum Contact kind = CONTACT_NONE;
+        int targetRow = 0, targetCol = 0;
+        float t, cnx, cny;
+
+        // Walls
+        if (dx < 0 && ball->x + dx < ball->radius)
+        {
+            t = (ball->radius - ball->x) / dx;
+            if (t < toi)
+                toi = t, nx = 1, ny = 0, kind = CONTACT_WALL;
+        }
+        else if (dx > 0 && ball->x + dx > screenWidth - ball->radius)
+        {
+            t = (screenWidth - ball->radius - ball->x) / dx;
+            if (t < toi)
+                toi = t, nx = -1, ny = 0, kind = CONTACT_WALL;
+        }
+        if (dy < 0 && ball->y + dy < ball->radius)
+        {
+            t = (ball->radius - ball->y) / dy;
+            if (t < toi)
+                toi = t, nx = 0, ny = 1, kind = CONTACT_CEILING;
+        }
+
+        // Paddle, only from above
+        if (dy > 0 && sweepCircleRect(ball->x, ball->y, dx, dy, ball->radius, paddle->x, paddle->y, paddle->width / 2, paddle->height / 2, &t, &cnx, &cny) && cny < 0 && t < toi)
+            toi = t, nx = cnx, ny = cny, kind = CONTACT_PADDLE;
+
+        // Bricks inside the swept bounds of the ball, visiting only the live
+        // bits of the rows and columns those bounds overlap
+        float minX = fminf(ball->x, ball->x + dx) - ball->radius;
+        float maxX = fmaxf(ball->x, ball->x + dx) + ball->radius;
+        float minY = fminf(ball->y, ball->y + dy) - ball->radius;
+        float maxY = fmaxf(ball->y, ball->y + dy) + ball->radius;
+        int firstRow = rowOf(bricks, minY);
+        int lastRow = rowOf(bricks, maxY);
+        if (firstRow < 0)
+            firstRow = 0;
+        if (lastRow > bricks->rows - 1)
+            lastRow = bricks->rows - 1;
+        for (int i = firstRow; i <= lastRow; i++)
+        {
+            uint64_t candidates = bricks->live[i] & columnMask(bricks, i, minX, maxX);
+            while (candidates)
+            {
+                int j = lowestBit(candidates);
+                candidates &= candidates - 1;
+                if (sweepCircleRect(ball->x, ball->y, dx, dy, ball->radius, brickX(bricks, i, j), brickY(bricks, i), BRICK_WIDTH / 2, BRICK_HEIGHT / 2, &t, &cnx, &cny) && t < toi)
+                    toi = t, nx = cnx, ny = cny, kind = CONTACT_BRICK, targetRow = i, targetCol = j;
+            }
+        }
+
+        ball->x += dx * toi;
+        ball->y += dy * toi;
+        if (kind == CONTACT_NONE)
+            break;
+        remaining *= 1.0f - toi;
+
+        if (kind == CONTACT_PADDLE)
+        {
+            bounceOffPaddle(ball, paddle);
+            events |= EVENT_BOUNCE;
+            continue;
+        }
+
+        float dot = ball->speedX * nx + ball->speedY * ny;
+        ball->speedX -= 2 * dot * nx;
+        ball->speedY -= 2 * dot * ny;
+
+        if (kind == CONTACT_WALL)
+            events |= EVENT_HIT;
+        else if (kind == CONTACT_BRICK)
+        {
+            int colorIndex = hitBrick(bricks, targetRow, targetCol, score);
+            if (*hitCount < MAX_BRICK_HITS)
+                hits[(*hitCount)++] = (BrickHit){brickX(bricks, targetRow, targetCol) - BRICK_WIDTH / 2, brickY(bricks, targetRow) - BRICK_HEIGHT / 2, BRICK_WIDTH, BRICK_HEIGHT, colorIndex};
+            events |= EVENT_IMPACT;
+        }
+    }
+
+    // Contact budget ran out, keep the ball inside the play field
+    if (ball->x < ball->radius)
+        ball->x = ball->radius;
+    else if (ball->x > screenWidth - ball->radius)
+        ball->x = screenWidth - ball->radius;
+    if (ball->y < ball->radius)
+        ball->y = ball->radius;
+    return events;
+}
+
+// Moves every ball through one step. Balls whose sweep is free flight are
+// advanced together in a branch-free pass; the rest go through the paddle
+// check and updateBall one at a time. Each destroyed brick may trigger a
+// split, applied once all balls have moved, and balls that fell out of the
+// bottom of the field are removed.
+unsigned int updateBalls(BallSet *balls, Paddle *paddle, BrickField *bricks, int screenWidth, int screenHeight, float dt, Rng *rng, int *score, BrickHit hits[], int *hitCount)
+{
+    const int count = balls->count;
+    const float radius = balls->radius;
+    const float width = screenWidth;
+    const float brickTop = bricks->top;
+    const float brickBottom = bricks->top + bricks->rows * BRICK_HEIGHT;
+    const float paddleTop = paddle->y - paddle->height / 2;
+    unsigned char contact[MAX_BALLS];
+    unsigned int events = 0;
+
+    for (int i = 0; i < count; i++)
+    {
+        float dx = balls->speedX[i] * dt;
+        float dy = balls->speedY[i] * dt;
+        int free = isFreeFlight(balls->x[i] + dx, balls->y[i], balls->y[i] + dy, radius, width, brickTop, brickBottom, paddleTop);
+        // Adding 1 * d gives the same bits as adding d
+        float blend = (float)free;
+        balls->x[i] += blend * dx;
+        balls->y[i] += blend * dy;
+        contact[i] = !free;
+    }
+
+    int splits = 0;
+    for (int i = 0; i < count; i++)
+    {
+        if (!contact[i])
+            continue;
+        Ball ball = {balls->x[i], balls->y[i], balls->speedX[i], balls->speedY[i], radius};
+        int liveBefore = bricks->liveCount;
+        if (paddleCollision(&ball, paddle))
+            events |= EVENT_BOUNCE;
+        events |= updateBall(&ball, paddle, bricks, screenWidth, dt, score, hits, hitCount);
+        for (int broken = liveBefore - bricks->liveCount; broken > 0; broken--)
+        {
+            if (rngRange(rng, 1, MULTIBALL_CHANCE) == 1)
+                splits++;
+        }
+        balls->x[i] = ball.x;
+        balls->y[i] = ball.y;
+        balls->speedX[i] = ball.speedX;
+        balls->speedY[i] = ball.speedY;
+    }
+
+    // Walk backwards so a ball swapped in from the end has already been checked
+    for (int i = balls->count - 1; i >= 0; i--)
+    {
+        if (balls->y[i] < screenHeight + SPRITE_SIZE)
+            continue;
+        int last = --balls->count;
+        balls->x[i] = balls->x[last];
+        balls->y[i] = balls->y[last];
+        balls->speedX[i] = balls->speedX[last];
+        balls->speedY[i] = balls->speedY[last];
+        balls->prevX[i] = balls->prevX[last];
+        balls->prevY[i] = balls->prevY[last];
+    }
+
+    for (; splits > 0 && balls->count > 0 && balls->count < MAX_BALLS; splits--)
+    {
+        splitBalls(balls);
+        events |= EVENT_MULTIBALL;
+    }
+    return events;
+}
+
+// Adds MULTIBALL_SPLIT - 1 copies of every ball, each turned a fixed angle
+// either side of the original so they fan out at the same speed
+void splitBalls(BallSet *balls)
+{
+    static const float turnCos = 0.906307787f; // 25 degrees
+    static const float turnSin = 0.422618262f;
+    const int count = balls->count;
+    for (int copy = 1; copy < MULTIBALL_SPLIT; copy++)
+    {
+        float sine = copy % 2 ? turnSin : -turnSin;
+        for (int i = 0; i < count && balls->count < MAX_BALLS; i++)
+        {
+            int n = balls->count++;
+            balls->x[n] = balls->x[i];
+            balls->y[n] = balls->y[i];
+            balls->prevX[n] = balls->prevX[i];
+            balls->prevY[n] = balls->prevY[i];
+            balls->speedX[n] = balls->speedX[i] * turnCos - balls->speedY[i] * sine;
+            balls->speedY[n] = balls->speedX[i] * sine + balls->speedY[i] * turnCos;
+        }
+    }
+}
+
+// Drops every ball but one and rests it on the paddle
+void serveBall(BallSet *balls, const Paddle *paddle)
+{
+    balls->count = 1;
+    balls->x[0] = paddle->x;
+    balls->y[0] = paddle->y - paddle->height - balls->radius;
+    // A fresh serve is not interpolated from where the last ball was
+    balls->prevX[0] = balls->x[0];
+    balls->prevY[0] = balls->y[0];
+    balls->speedX[0] = 0;
+    balls->speedY[0] = 0;
+}
+
+void resetBall(Ball *ball, float x, float y)
+{
+    ball->x = x;
+    ball->y = y;
+    ball->speedX = 0;
+    ball->speedY = 0;
+}
+
+// Catches the paddle moving into the ball, which the ball's own sweep can't see
+bool paddleCollision(Ball *ball, Paddle *paddle)
+{
+    if (ball->speedY >= 0 && circleRectOverlap(ball->x, ball->y, ball->radius, paddle->x, paddle->y, paddle->width, paddle->height) && ball->y <= paddle->y + paddle->height / 2)
+    {
+        ball->y = paddle->y - paddle->height / 2 - ball->radius;
+        bounceOffPaddle(ball, paddle);
+        return true;
+    }
+    return false;
+}
+
+static void bounceOffPaddle(Ball *ball, const Paddle *paddle)
+{
+    ball->speedY = -fabsf(ball->speedY);
+
+    if (ball->speedX < 0 && ball->x < paddle->x)
+    {
+        ball->speedX = -BALL_SPEED + (paddle->x - ball->x) * -10;
+    }
+    else if (ball->speedX > 0 && ball->x > paddle->x)
+    {
+        ball->speedX = BALL_SPEED + (ball->x - paddle->x) * 10;
+    }
+}
+
+// Earliest time of impact in [0, 1] of a circle moving by (dx, dy) against a
+// rect given by its center and half extents. The rect is grown by the radius
+// into a rounded box; the ray is clipped against its slabs and, when it lands
+// in a corner region, against the corner circle instead. Contacts the circle
+// is moving away from, or already overlapping at the start, are ignored.
+static bool sweepCircleRect(float x, float y, float dx, float dy, float radius, float cx, float cy, float halfW, float halfH, float *toi, float *nx, float *ny)
+{
+    float tEnter = -INFINITY, tExit = INFINITY;
+    float enterNx = 0, enterNy = 0;
+
+    if (dx == 0)
+    {
+        if (x < cx - halfW - radius || x > cx + halfW + radius)
+            return false;
+    }
+    else
+    {
+        float t1 = (cx - halfW - radius - x) / dx;
+        float t2 = (cx + halfW + radius - x) / dx;
+        float n = -1;
+        if (t1 > t2)
+        {
+            float temp = t1;
+            t1 = t2;
+            t2 = temp;
+            n = 1;
+        }
+        tEnter = t1, enterNx = n;
+        tExit = t2;
+    }
+
+    if (dy == 0)
+    {
+        if (y < cy - halfH - radius || y > cy + halfH + radius)
+            return false;
+    }
+    else
+    {
+        float t1 = (cy - halfH - radius - y) / dy;
+        float t2 = (cy + halfH + radius - y) / dy;
+        float n = -1;
+        if (t1 > t2)
+        {
+            float temp = t1;
+            t1 = t2;
+            t2 = temp;
+            n = 1;
+        }
+        if (t1 > tEnter)
+            tEnter = t1, enterNx = 0, enterNy = n;
+        if (t2 < tExit)
+            tExit = t2;
+    }
+
+    if (tEnter > tExit || tExit < 0 || tEnter > 1)
+        return false;
+
+    // A start inside the grown box is only an overlap outside its corners
+    float te = tEnter < 0 ? 0 : tEnter;
+    float hx = x + dx * te;
+    float hy = y + dy * te;
+    bool outsideX = hx < cx - halfW || hx > cx + halfW;
+    bool outsideY = hy < cy - halfH || hy > cy + halfH;
+    if (!(outsideX && outsideY) && tEnter < 0)
+        return false;
+    if (outsideX && outsideY)
+    {
+        float cornerX = hx < cx ? cx - halfW : cx + halfW;
+        float cornerY = hy < cy ? cy - halfH : cy + halfH;
+        float ox = x - cornerX;
+        float oy = y - cornerY;
+        float a = dx * dx + dy * dy;
+        float b = ox * dx + oy * dy;
+        float c = ox * ox + oy * oy - radius * radius;
+        float disc = b * b - a * c;
+        if (c < 0 || disc < 0)
+            return false;
+        tEnter = (-b - sqrtf(disc)) / a;
+        if (tEnter < 0 || tEnter > 1)
+            return false;
+        enterNx = (x + dx * tEnter - cornerX) / radius;
+        enterNy = (y + dy * tEnter - cornerY) / radius;
+    }
+
+    if (enterNx * dx + enterNy * dy >= 0)
+        return false;
+    *toi = tEnter;
+    *nx = enterNx;
+    *ny = enterNy;
+    return true;
+}
+
+// Same test as raylib's CheckCollisionCircleRec, with the rect given by its center
+static bool circleRectOverlap(float cx, float cy, float radius, float rx, float ry, float width, float height)
+{
+    float dx = fabsf(cx - (int)rx);
+    float dy = fabsf(cy - (int)ry);
+    float halfW = width / 2.0f;
+    float halfH = height / 2.0f;
+
+    if (dx > halfW + radius || dy > halfH + radius)
+        return false;
+    if (dx <= halfW || dy <= halfH)
+        return true;
+    float cornerDistanceSq = (dx - halfW) * (dx - halfW) + (dy - halfH) * (dy - halfH);
+    return cornerDistanceSq <= radius * radius;
+}
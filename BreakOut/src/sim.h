@@ -0,0 +1,199 @@
+#ifndef BREAKOUT_SIM_H
+#define BREAKOUT_SIM_H
+
+#include <stdbool.h>
+
+#include "bricks.h"
+#include "endless.h"
+#include "rng.h"
+
+// Window-free BreakOut simulation. Nothing in here touches raylib, so a
+// GameState can be stepped without InitWindow/InitAudioDevice.
+
+#define MAX_ROWS 4
+#define MAX_COLS 11
+#define BALL_SPEED 250
+#define PAD_SPEED 900
+#define SPRITE_SIZE 32
+#define PADDLE_TOTAL 4
+#define MAX_BRICK_HITS 8
+#define MAX_BALL_CONTACTS 8
+#define MAX_BALLS 512
+// One destroyed brick in this many splits every ball in play
+#define MULTIBALL_CHANCE 8
+#define MULTIBALL_SPLIT 3
+#define SIM_TICK_RATE 240
+// Highest rate a fixed-step clock or a replay may run at
+#define SIM_MAX_TICK_RATE 4000
+#define SIM_MAX_FRAME_TIME 0.25f
+
+// Input bits, sampled once per step
+#define INPUT_LEFT (1 << 0)
+#define INPUT_RIGHT (1 << 1)
+#define INPUT_UP (1 << 2)
+#define INPUT_DOWN (1 << 3)
+#define INPUT_SPACE (1 << 4)
+#define INPUT_ENTER (1 << 5)
+
+// Events raised during a step, consumed by the front end for sound and effects
+#define EVENT_SELECT (1 << 0)
+#define EVENT_DISABLE (1 << 1)
+#define EVENT_BOUNCE (1 << 2)
+#define EVENT_HIT (1 << 3)
+#define EVENT_IMPACT (1 << 4)
+#define EVENT_FALL (1 << 5)
+#define EVENT_PAUSE (1 << 6)
+#define EVENT_VICTORY (1 << 7)
+#define EVENT_MULTIBALL (1 << 8)
+
+enum State
+{
+    MENU,
+    SETTING,
+    PLAY,
+    GAMEOVER,
+    VICTORY,
+    SCOREBOARD,
+    PAUSED,
+    // Set by the frontend while a screen waits on its assets; stepGame is
+    // not called in it, so it never appears in replays or snapshots
+    LOADING
+};
+
+typedef struct Ball
+{
+    float x, y;
+    float speedX, speedY;
+    float radius;
+} Ball;
+
+// Every ball in play as parallel arrays. Ball 0 is the one served from the
+// paddle; multi-ball splits append to the set and balls that fall out of the
+// field are swap-removed. prevX/prevY hold the positions at the start of the
+// last step for render interpolation.
+typedef struct BallSet
+{
+    float x[MAX_BALLS], y[MAX_BALLS];
+    float speedX[MAX_BALLS], speedY[MAX_BALLS];
+    float prevX[MAX_BALLS], prevY[MAX_BALLS];
+    int count;
+    float radius;
+} BallSet;
+
+typedef struct Paddle
+{
+    float x, y;
+    float speed;
+    float width, height;
+} Paddle;
+
+typedef struct BrickHit
+{
+    float x, y;
+    float width, height;
+    int colorIndex;
+} BrickHit;
+
+enum Mode
+{
+    MODE_CLASSIC,
+    MODE_ENDLESS
+};
+
+typedef struct Setting
+{
+    int paddle;
+    int difficulty;
+    int mode;
+} Setting;
+
+typedef struct GameInput
+{
+    unsigned int down;
+    unsigned int pressed;
+} GameInput;
+
+struct ChunkStream;
+
+typedef struct GameState
+{
+    enum State state;
+    int screenWidth, screenHeight;
+    int level;
+    int lives;
+    int score;
+    int menuIndex;
+    Setting setting;
+    BallSet balls;
+    Paddle paddle;
+    float prevPaddleX;
+    BrickField bricks;
+    Rng levelRng;
+    Rng gameRng;
+    unsigned int events;
+    BrickHit hits[MAX_BRICK_HITS];
+    int hitCount;
+    // Endless mode: rows fed in so far from the run's seed. The chunk the
+    // next rows come from is cached in chunk, taken from chunkStream when
+    // one is set; neither is part of the state, a chunk is rebuilt from the
+    // seed whenever the cached one is not the one needed.
+    bool endless;
+    uint64_t endlessSeed;
+    uint32_t endlessRows;
+    BrickChunk chunk;
+    struct ChunkStream *chunkStream;
+} GameState;
+
+struct Replay;
+
+// Accumulator that runs stepGame at a fixed rate regardless of render rate.
+// When playback is set its ticks replace live input until it runs out; when
+// recording is set every tick's input is appended to it.
+typedef struct FixedStep
+{
+    int tickRate;
+    float tickDt;
+    float accumulator;
+    unsigned int pendingPressed;
+    unsigned int events;
+    BrickHit hits[MAX_BRICK_HITS];
+    int hitCount;
+    struct Replay *playback;
+    struct Replay *recording;
+} FixedStep;
+
+void initGameState(GameState *game, int screenWidth, int screenHeight, uint64_t seed);
+void stepGame(GameState *game, GameInput input, float dt);
+
+void initFixedStep(FixedStep *clock, int tickRate);
+int advanceFixedStep(FixedStep *clock, GameState *game, GameInput input, float frameTime);
+float fixedStepAlpha(const FixedStep *clock);
+
+unsigned int updateBall(Ball *ball, Paddle *paddle, BrickField *bricks, int screenWidth, float dt, int *score, BrickHit hits[], int *hitCount);
+unsigned int updateBalls(BallSet *balls, Paddle *paddle, BrickField *bricks, int screenWidth, int screenHeight, float dt, Rng *rng, int *score, BrickHit hits[], int *hitCount);
+void splitBalls(BallSet *balls);
+void serveBall(BallSet *balls, const Paddle *paddle);
+void resetBall(Ball *ball, float x, float y);
+void paddleControl(Paddle *paddle, GameInput input, int screenWidth, float dt);
+bool paddleCollision(Ball *ball, Paddle *paddle);
+
+// Ball 0 resting on the paddle, waiting to be launched
+static inline bool isBallServed(const BallSet *balls)
+{
+    return balls->count == 1 && balls->speedX[0] == 0 && balls->speedY[0] == 0;
+}
+
+// True when a sweep ending at x1 and covering y0..y1 stays clear of the side
+// walls, the ceiling, the paddle and the brick rows, in which case the ball
+// moves exactly as updateBall would move it without any contact. Both bands
+// are intervals, so checking the two ends of the sweep covers all of it.
+// Written with & and | so loops over many balls stay branch-free.
+static inline int isFreeFlight(float x1, float y0, float y1, float radius, float width, float brickTop, float brickBottom, float paddleTop)
+{
+    int inside = (x1 > radius) & (x1 < width - radius);
+    int belowBricks = (y0 - radius > brickBottom) & (y1 - radius > brickBottom) & (y0 + radius < paddleTop) & (y1 + radius < paddleTop);
+    int aboveBricks = (y0 > radius) & (y1 > radius) & (y0 + radius < brickTop) & (y1 + radius < brickTop);
+    return inside & (belowBricks | aboveBricks);
+}
+
+#endif
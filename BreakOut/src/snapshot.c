@@ -0,0 +1,294 @@
+#include "snapshot.h"
+#include "byte_stream.h"
+#include "memtrack.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const unsigned char snapshotMagic[4] = {'B', 'R', 'S', 'V'};
+
+#define SNAPSHOT_PARTICLES 1
+
+// Layout: magic, version, flags, then the game state with bricks stored as
+// one live mask per row plus health and tier for live cells only, then the
+// balls, then (flag SNAPSHOT_PARTICLES) the particle pool. Per-step output
+// such as events and hits is not stored. Returns 0 if the buffer is too small.
+size_t writeSnapshot(unsigned char *buffer, size_t capacity, const GameState *game, const ParticleSystem *particles)
+{
+    ByteStream out = {buffer, 0, capacity, 0, false};
+    putBytes(&out, snapshotMagic, sizeof(snapshotMagic));
+    putU16(&out, SNAPSHOT_VERSION);
+    putU16(&out, particles ? SNAPSHOT_PARTICLES : 0);
+
+    putU8(&out, game->state);
+    putU8(&out, game->menuIndex);
+    putU8(&out, game->setting.paddle);
+    putU8(&out, game->setting.difficulty);
+    putU16(&out, game->screenWidth);
+    putU16(&out, game->screenHeight);
+    putU32(&out, game->level);
+    putU32(&out, game->lives);
+    putU32(&out, game->score);
+    putF32(&out, game->paddle.x);
+    putRng(&out, &game->levelRng);
+    putRng(&out, &game->gameRng);
+    putU8(&out, game->setting.mode);
+    putU8(&out, game->endless);
+    putU64(&out, game->endlessSeed);
+    putU32(&out, game->endlessRows);
+
+    const BrickField *bricks = &game->bricks;
+    putU8(&out, bricks->rows);
+    putU8(&out, bricks->cols);
+    putF32(&out, bricks->top);
+    for (int i = 0; i < bricks->rows; i++)
+    {
+        putF32(&out, bricks->rowX[i]);
+        putU64(&out, bricks->live[i]);
+        for (uint64_t live = bricks->live[i]; live; live &= live - 1)
+        {
+            int index = brickIndex(i, lowestBit(live));
+            putU8(&out, bricks->health[index]);
+            putU8(&out, bricks->tier[index]);
+        }
+    }
+
+    const BallSet *balls = &game->balls;
+    putU16(&out, balls->count);
+    for (int i = 0; i < balls->count; i++)
+    {
+        putF32(&out, balls->x[i]);
+        putF32(&out, balls->y[i]);
+        putF32(&out, balls->speedX[i]);
+        putF32(&out, balls->speedY[i]);
+    }
+
+    if (particles)
+    {
+        putRng(&out, &particles->rng);
+        putBytes(&out, particles->jitterRng.s, sizeof(particles->jitterRng.s));
+        putU32(&out, particles->count);
+        for (int i = 0; i < particles->count; i++)
+        {
+            putF32(&out, particles->x[i]);
+            putF32(&out, particles->y[i]);
+            putF32(&out, particles->alpha[i]);
+            putBytes(&out, &particles->color[i], sizeof(ParticleColor));
+        }
+    }
+    return out.failed ? 0 : out.position;
+}
+
+// Decodes into a scratch copy and only overwrites game (and particles, when
+// the snapshot has them and particles is given) if everything checks out
+bool readSnapshot(const unsigned char *buffer, size_t size, GameState *game, ParticleSystem *particles)
+{
+    GameState loaded;
+    ByteStream in = {0, buffer, size, 0, false};
+    unsigned char magic[4];
+    getBytes(&in, magic, sizeof(magic));
+    if (in.failed || memcmp(magic, snapshotMagic, sizeof(magic)) != 0 || getU16(&in) != SNAPSHOT_VERSION)
+        return false;
+    uint32_t flags = getU16(&in);
+
+    loaded = *game;
+    loaded.state = getU8(&in);
+    loaded.menuIndex = getU8(&in);
+    loaded.setting.paddle = getU8(&in);
+    loaded.setting.difficulty = getU8(&in);
+    loaded.screenWidth = getU16(&in);
+    loaded.screenHeight = getU16(&in);
+    loaded.level = (int32_t)getU32(&in);
+    loaded.lives = (int32_t)getU32(&in);
+    loaded.score = (int32_t)getU32(&in);
+    loaded.paddle.x = getF32(&in);
+    loaded.prevPaddleX = loaded.paddle.x;
+    getRng(&in, &loaded.levelRng);
+    getRng(&in, &loaded.gameRng);
+    loaded.setting.mode = getU8(&in);
+    loaded.endless = getU8(&in) != 0;
+    loaded.endlessSeed = getU64(&in);
+    loaded.endlessRows = getU32(&in);
+    if (loaded.state > PAUSED || loaded.menuIndex > 1 || loaded.setting.paddle >= PADDLE_TOTAL || loaded.setting.mode > MODE_ENDLESS)
+        return false;
+
+    BrickField *bricks = &loaded.bricks;
+    int rows = getU8(&in);
+    int cols = getU8(&in);
+    if (rows > FIELD_MAX_ROWS || cols > FIELD_MAX_COLS)
+        return false;
+    initBrickField(bricks, rows, cols);
+    bricks->top = getF32(&in);
+    for (int i = 0; i < rows && !in.failed; i++)
+    {
+        bricks->rowX[i] = getF32(&in);
+        uint64_t live = getU64(&in);
+        if (cols < 64 && live >> cols)
+            return false;
+        bricks->live[i] = live;
+        for (; live; live &= live - 1)
+        {
+            int index = brickIndex(i, lowestBit(live));
+            bricks->health[index] = getU8(&in);
+            bricks->tier[index] = getU8(&in);
+            // Both index the brick sprites, so a bad one is never let through
+            if (bricks->health[index] == 0 || bricks->health[index] > BRICK_HEALTH || bricks->tier[index] >= BRICK_TIER)
+                return false;
+            bricks->liveCount++;
+        }
+    }
+
+    BallSet *balls = &loaded.balls;
+    balls->count = getU16(&in);
+    if (balls->count > MAX_BALLS)
+        return false;
+    for (int i = 0; i < balls->count; i++)
+    {
+        balls->x[i] = balls->prevX[i] = getF32(&in);
+        balls->y[i] = balls->prevY[i] = getF32(&in);
+        balls->speedX[i] = getF32(&in);
+        balls->speedY[i] = getF32(&in);
+    }
+    loaded.events = 0;
+    loaded.hitCount = 0;
+    if (in.failed)
+        return false;
+
+    if (flags & SNAPSHOT_PARTICLES)
+    {
+        Rng rng;
+        RngBatch jitterRng;
+        getRng(&in, &rng);
+        getBytes(&in, jitterRng.s, sizeof(jitterRng.s));
+        uint32_t count = getU32(&in);
+        if (in.failed || count > (size - in.position) / 16)
+            return false;
+        if (particles)
+        {
+            if ((int)count > particles->capacity)
+                return false;
+            particles->rng = rng;
+            particles->jitterRng = jitterRng;
+            particles->count = count;
+            for (uint32_t i = 0; i < count; i++)
+            {
+                particles->x[i] = getF32(&in);
+                particles->y[i] = getF32(&in);
+                particles->alpha[i] = getF32(&in);
+                getBytes(&in, &particles->color[i], sizeof(ParticleColor));
+            }
+        }
+    }
+
+    *game = loaded;
+    return true;
+}
+
+bool saveSnapshot(const char *fileName, const GameState *game, const ParticleSystem *particles)
+{
+    size_t capacity = SNAPSHOT_MAX_SIZE + 256 + (particles ? (size_t)particles->count * 16 : 0);
+    unsigned char *buffer = memAlloc(capacity, MEM_SIM);
+    if (!buffer)
+        return false;
+    size_t size = writeSnapshot(buffer, capacity, game, particles);
+    FILE *file = size ? fopen(fileName, "wb") : 0;
+    bool ok = file && fwrite(buffer, 1, size, file) == size;
+    if (file)
+        ok = fclose(file) == 0 && ok;
+    memFree(buffer);
+    return ok;
+}
+
+bool loadSnapshot(const char *fileName, GameState *game, ParticleSystem *particles)
+{
+    FILE *file = fopen(fileName, "rb");
+    if (!file)
+        return false;
+    size_t capacity = SNAPSHOT_MAX_SIZE + 256 + (particles ? (size_t)particles->capacity * 16 : 0);
+    unsigned char *buffer = memAlloc(capacity, MEM_SIM);
+    size_t size = buffer ? fread(buffer, 1, capacity, file) : 0;
+    fclose(file);
+    bool ok = size && readSnapshot(buffer, size, game, particles);
+    memFree(buffer);
+    return ok;
+}
+
+bool initRewindBuffer(RewindBuffer *rewind, int slots, int capacity)
+{
+    if (capacity < SNAPSHOT_MAX_SIZE)
+        capacity = SNAPSHOT_MAX_SIZE;
+    rewind->data = memAlloc(capacity + 2 * sizeof(int) * slots, MEM_SIM);
+    if (!rewind->data)
+    {
+        rewind->slots = 0;
+        return false;
+    }
+    rewind->offset = (int *)(rewind->data + capacity);
+    rewind->size = rewind->offset + slots;
+    rewind->capacity = capacity;
+    rewind->slots = slots;
+    clearRewindBuffer(rewind);
+    return true;
+}
+
+void unloadRewindBuffer(RewindBuffer *rewind)
+{
+    memFree(rewind->data);
+    rewind->data = 0;
+    rewind->slots = 0;
+}
+
+void clearRewindBuffer(RewindBuffer *rewind)
+{
+    rewind->first = 0;
+    rewind->count = 0;
+    rewind->end = 0;
+}
+
+// Appends a snapshot of game, evicting the oldest entries until it fits
+bool pushRewind(RewindBuffer *rewind, const GameState *game)
+{
+    unsigned char scratch[SNAPSHOT_MAX_SIZE];
+    size_t size = writeSnapshot(scratch, sizeof(scratch), game, 0);
+    if (!size || rewind->slots == 0)
+        return false;
+
+    // New entries go after the newest one, or back at the start of the ring
+    // when the tail is too short. Entries are laid out oldest first, so on a
+    // wrap everything past the old end is older than what sits at the start
+    // and has to go before the overlap check reaches the start.
+    int start = rewind->end;
+    bool wrapped = start + (int)size > rewind->capacity;
+    if (wrapped)
+        start = 0;
+    while (rewind->count > 0)
+    {
+        int oldest = rewind->offset[rewind->first];
+        bool stale = wrapped && oldest >= rewind->end;
+        bool overlaps = oldest < start + (int)size && start < oldest + rewind->size[rewind->first];
+        if (!stale && !overlaps && rewind->count < rewind->slots)
+            break;
+        rewind->first = (rewind->first + 1) % rewind->slots;
+        rewind->count--;
+    }
+
+    int slot = (rewind->first + rewind->count) % rewind->slots;
+    memcpy(rewind->data + start, scratch, size);
+    rewind->offset[slot] = start;
+    rewind->size[slot] = (int)size;
+    rewind->count++;
+    rewind->end = start + (int)size;
+    return true;
+}
+
+// Restores the newest snapshot and drops it, false once the history is empty
+bool popRewind(RewindBuffer *rewind, GameState *game)
+{
+    if (rewind->count == 0)
+        return false;
+    int slot = (rewind->first + rewind->count - 1) % rewind->slots;
+    rewind->count--;
+    rewind->end = rewind->count ? rewind->offset[slot] : 0;
+    return readSnapshot(rewind->data + rewind->offset[slot], rewind->size[slot], game, 0);
+}
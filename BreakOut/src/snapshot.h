@@ -0,0 +1,43 @@
+#ifndef BREAKOUT_SNAPSHOT_H
+#define BREAKOUT_SNAPSHOT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "particles.h"
+#include "sim.h"
+
+#define SNAPSHOT_VERSION 2
+
+// Upper bound of a snapshot without particles: header, both generators, the
+// endless run, a full brick field and a full ball set
+#define SNAPSHOT_MAX_SIZE (64 + 32 + 16 + FIELD_MAX_ROWS * 12 + FIELD_MAX_ROWS * FIELD_MAX_COLS * 2 + 8 + MAX_BALLS * 16)
+
+// Rolling history of recent snapshots for rewinding. Snapshots vary in size
+// with the number of balls, so they are packed back to back into one byte
+// ring and the oldest ones are dropped to make room.
+typedef struct RewindBuffer
+{
+    unsigned char *data;
+    int capacity;
+    int *offset;
+    int *size;
+    int slots;
+    int first;
+    int count;
+    int end;
+} RewindBuffer;
+
+size_t writeSnapshot(unsigned char *buffer, size_t capacity, const GameState *game, const ParticleSystem *particles);
+bool readSnapshot(const unsigned char *buffer, size_t size, GameState *game, ParticleSystem *particles);
+bool saveSnapshot(const char *fileName, const GameState *game, const ParticleSystem *particles);
+bool loadSnapshot(const char *fileName, GameState *game, ParticleSystem *particles);
+
+bool initRewindBuffer(RewindBuffer *rewind, int slots, int capacity);
+void unloadRewindBuffer(RewindBuffer *rewind);
+void clearRewindBuffer(RewindBuffer *rewind);
+bool pushRewind(RewindBuffer *rewind, const GameState *game);
+bool popRewind(RewindBuffer *rewind, GameState *game);
+
+#endif
@@ -0,0 +1,152 @@
+#include "sound_manager.h"
+#include "memtrack.h"
+
+#include <string.h>
+
+void initSoundManager(SoundManager *manager, int mixLimit)
+{
+    memset(manager, 0, sizeof(*manager));
+    manager->mixLimit = mixLimit;
+}
+
+int addSoundEffect(SoundManager *manager, int polyphony, int priority)
+{
+    if (manager->effectCount == SOUND_MAX_EFFECTS || polyphony < 1 || manager->voiceCount + polyphony > SOUND_MAX_VOICES)
+        return -1;
+    int id = manager->effectCount++;
+    SoundEffect *effect = &manager->effects[id];
+    effect->firstVoice = manager->voiceCount;
+    effect->polyphony = polyphony;
+    effect->priority = priority;
+    for (int v = 0; v < polyphony; v++)
+        manager->voices[manager->voiceCount++].effect = id;
+
+    // Keep the flush order highest priority first
+    int i = id;
+    while (i > 0 && manager->effects[manager->order[i - 1]].priority < priority)
+    {
+        manager->order[i] = manager->order[i - 1];
+        i--;
+    }
+    manager->order[i] = id;
+    return id;
+}
+
+Sound *soundEffectSource(SoundManager *manager, int effect)
+{
+    return &manager->effects[effect].source;
+}
+
+void triggerSound(SoundManager *manager, int effect, int count)
+{
+    if (effect >= 0 && effect < manager->effectCount)
+        manager->effects[effect].pending += count;
+}
+
+static bool makeAliases(SoundEffect *effect, SoundVoice *voices)
+{
+    if (!IsSoundReady(effect->source))
+        return false;
+    int tag = memtrackPushTag(MEM_AUDIO);
+    for (int v = 0; v < effect->polyphony; v++)
+        voices[effect->firstVoice + v].alias = LoadSoundAlias(effect->source);
+    memtrackPopTag(tag);
+    effect->aliased = true;
+    return true;
+}
+
+// Lowest priority first, then oldest; -1 if every playing voice outranks priority
+static int findVictim(const SoundManager *manager, int priority)
+{
+    int victim = -1;
+    for (int v = 0; v < manager->voiceCount; v++)
+    {
+        const SoundVoice *voice = &manager->voices[v];
+        if (!voice->playing)
+            continue;
+        int voicePriority = manager->effects[voice->effect].priority;
+        if (voicePriority > priority)
+            continue;
+        if (victim < 0)
+        {
+            victim = v;
+            continue;
+        }
+        const SoundVoice *best = &manager->voices[victim];
+        int bestPriority = manager->effects[best->effect].priority;
+        if (voicePriority < bestPriority || (voicePriority == bestPriority && voice->started < best->started))
+            victim = v;
+    }
+    return victim;
+}
+
+static void startEffect(SoundManager *manager, SoundEffect *effect, int *playing)
+{
+    // A free voice of this effect, otherwise its oldest one gets restarted
+    SoundVoice *voices = manager->voices + effect->firstVoice;
+    SoundVoice *voice = &voices[0];
+    for (int v = 0; v < effect->polyphony; v++)
+    {
+        if (!voices[v].playing)
+        {
+            voice = &voices[v];
+            break;
+        }
+        if (voices[v].started < voice->started)
+            voice = &voices[v];
+    }
+
+    if (!voice->playing)
+    {
+        if (*playing >= manager->mixLimit)
+        {
+            int victim = findVictim(manager, effect->priority);
+            if (victim < 0)
+                return;
+            StopSound(manager->voices[victim].alias);
+            manager->voices[victim].playing = false;
+            (*playing)--;
+        }
+        (*playing)++;
+    }
+    PlaySound(voice->alias);
+    voice->started = manager->frame;
+    voice->playing = true;
+}
+
+void flushSounds(SoundManager *manager)
+{
+    manager->frame++;
+    int playing = 0;
+    for (int v = 0; v < manager->voiceCount; v++)
+    {
+        SoundVoice *voice = &manager->voices[v];
+        if (voice->playing)
+            voice->playing = IsSoundPlaying(voice->alias);
+        playing += voice->playing;
+    }
+
+    for (int i = 0; i < manager->effectCount; i++)
+    {
+        SoundEffect *effect = &manager->effects[manager->order[i]];
+        if (effect->pending > 0 && (effect->aliased || makeAliases(effect, manager->voices)))
+            startEffect(manager, effect, &playing);
+        effect->pending = 0;
+    }
+}
+
+void unloadSoundManager(SoundManager *manager)
+{
+    for (int e = 0; e < manager->effectCount; e++)
+    {
+        SoundEffect *effect = &manager->effects[e];
+        if (effect->aliased)
+        {
+            for (int v = 0; v < effect->polyphony; v++)
+                UnloadSoundAlias(manager->voices[effect->firstVoice + v].alias);
+        }
+        if (IsSoundReady(effect->source))
+            UnloadSound(effect->source);
+    }
+    memset(manager, 0, sizeof(*manager));
+}
@@ -0,0 +1,56 @@
+#ifndef BREAKOUT_SOUND_MANAGER_H
+#define BREAKOUT_SOUND_MANAGER_H
+
+#include <stdbool.h>
+
+#include "raylib.h"
+
+#define SOUND_MAX_EFFECTS 16
+#define SOUND_MAX_VOICES 32
+
+typedef struct SoundEffect
+{
+    Sound source;
+    int firstVoice;
+    int polyphony;
+    int priority;
+    int pending;
+    bool aliased;
+} SoundEffect;
+
+typedef struct SoundVoice
+{
+    Sound alias;
+    int effect;
+    unsigned int started;
+    bool playing;
+} SoundVoice;
+
+// Fixed pool of voices. Each effect owns `polyphony` aliases of its source, so
+// overlapping plays share one sample buffer; at most mixLimit voices play at
+// once across all effects. Triggers are only counted during the frame and
+// flushSounds starts at most one voice per effect, since copies started in
+// the same frame would play in phase. A full effect restarts its oldest voice;
+// a full mixer stops the lowest priority, oldest voice if it does not outrank
+// the new one, and drops the trigger otherwise.
+typedef struct SoundManager
+{
+    SoundEffect effects[SOUND_MAX_EFFECTS];
+    int order[SOUND_MAX_EFFECTS]; // effect ids, highest priority first
+    int effectCount;
+    SoundVoice voices[SOUND_MAX_VOICES];
+    int voiceCount;
+    int mixLimit;
+    unsigned int frame;
+} SoundManager;
+
+void initSoundManager(SoundManager *manager, int mixLimit);
+// Returns the effect id, or -1 when the pool is full. The source is loaded
+// into soundEffectSource(); aliases are made once it is ready.
+int addSoundEffect(SoundManager *manager, int polyphony, int priority);
+Sound *soundEffectSource(SoundManager *manager, int effect);
+void triggerSound(SoundManager *manager, int effect, int count);
+void flushSounds(SoundManager *manager);
+void unloadSoundManager(SoundManager *manager);
+
+#endif
@@ -0,0 +1,41 @@
+#ifndef BREAKOUT_SPRITE_ATLAS_H
+#define BREAKOUT_SPRITE_ATLAS_H
+
+#include "raylib.h"
+#include "bricks.h"
+#include "sim.h"
+
+// A frame's region in the texture and where its trimmed pixels sit inside
+// the untrimmed frame
+typedef struct SpriteFrame
+{
+    Rectangle src;
+    float offsetX, offsetY;
+} SpriteFrame;
+
+// Every frame BreakOut draws. The tables themselves are generated by
+// bake_atlas into atlas_frames.h, one for the baked atlas and one for the
+// original sheet.
+typedef struct SpriteAtlas
+{
+    const char *asset;
+    SpriteFrame paddle[PADDLE_TOTAL];
+    // Indexed by tier, then health - 1
+    SpriteFrame brick[BRICK_TIER][BRICK_HEALTH];
+    SpriteFrame heartFull;
+    SpriteFrame heartEmpty;
+    SpriteFrame ball;
+} SpriteAtlas;
+
+static inline const SpriteFrame *brickFrame(const SpriteAtlas *atlas, int tier, int health)
+{
+    return &atlas->brick[tier][health - 1];
+}
+
+// x, y is the top-left corner of the untrimmed frame
+static inline void drawSpriteFrame(Texture2D texture, const SpriteFrame *frame, float x, float y, Color tint)
+{
+    DrawTextureRec(texture, frame->src, (Vector2){x + frame->offsetX, y + frame->offsetY}, tint);
+}
+
+#endif
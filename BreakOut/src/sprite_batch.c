@@ -0,0 +1,173 @@
+#include "sprite_batch.h"
+#include "memtrack.h"
+
+#include <stdbool.h>
+#include <stdlib.h>
+
+void initSpriteBatch(SpriteBatch *batch, int capacity)
+{
+    batch->batch = rlLoadRenderBatch(1, capacity < SPRITE_BATCH_GL_QUADS ? capacity : SPRITE_BATCH_GL_QUADS);
+    batch->quads = memAlloc(sizeof(SpriteQuad) * capacity, MEM_RENDER);
+    batch->order = memAlloc(sizeof(int) * capacity, MEM_RENDER);
+    batch->capacity = batch->quads && batch->order ? capacity : 0;
+    batch->count = 0;
+    batch->runCount = 0;
+    batch->lastRun = -1;
+    batch->stats = (SpriteBatchStats){0};
+}
+
+void unloadSpriteBatch(SpriteBatch *batch)
+{
+    rlUnloadRenderBatch(batch->batch);
+    memFree(batch->quads);
+    memFree(batch->order);
+    batch->quads = NULL;
+    batch->order = NULL;
+    batch->capacity = 0;
+}
+
+// Consecutive quads nearly always share a run, so check the last one first
+static int findRun(SpriteBatch *batch, int layer, int blend, unsigned int texture)
+{
+    if (batch->lastRun >= 0)
+    {
+        const SpriteRun *run = &batch->runs[batch->lastRun];
+        if (run->layer == layer && run->blend == blend && run->texture == texture)
+            return batch->lastRun;
+    }
+    for (int i = 0; i < batch->runCount; i++)
+    {
+        const SpriteRun *run = &batch->runs[i];
+        if (run->layer == layer && run->blend == blend && run->texture == texture)
+            return batch->lastRun = i;
+    }
+    if (batch->runCount == SPRITE_BATCH_MAX_RUNS)
+        return -1;
+    batch->runs[batch->runCount] = (SpriteRun){layer, blend, texture, 0, 0};
+    return batch->lastRun = batch->runCount++;
+}
+
+void batchQuad(SpriteBatch *batch, int layer, int blend, unsigned int texture, Rectangle dest, float u0, float v0, float u1, float v1, Color tint)
+{
+    int run = batch->count < batch->capacity ? findRun(batch, layer, blend, texture) : -1;
+    if (run < 0)
+    {
+        batch->stats.dropped++;
+        return;
+    }
+    batch->runs[run].count++;
+    batch->quads[batch->count++] = (SpriteQuad){dest.x, dest.y, dest.width, dest.height, u0, v0, u1, v1, tint, run};
+}
+
+void batchTextureRec(SpriteBatch *batch, int layer, Texture2D texture, Rectangle src, Vector2 position, Color tint)
+{
+    float width = src.width < 0 ? -src.width : src.width;
+    float height = src.height < 0 ? -src.height : src.height;
+    float u0 = src.x / texture.width, u1 = (src.x + width) / texture.width;
+    float v0 = src.y / texture.height, v1 = (src.y + height) / texture.height;
+    if (src.width < 0)
+    {
+        float u = u0;
+        u0 = u1;
+        u1 = u;
+    }
+    if (src.height < 0)
+    {
+        float v = v0;
+        v0 = v1;
+        v1 = v;
+    }
+    batchQuad(batch, layer, BLEND_ALPHA, texture.id, (Rectangle){position.x, position.y, width, height}, u0, v0, u1, v1, tint);
+}
+
+void batchRectangle(SpriteBatch *batch, int layer, Rectangle rec, Color color)
+{
+    batchQuad(batch, layer, BLEND_ALPHA, rlGetTextureIdDefault(), rec, 0.0f, 0.0f, 1.0f, 1.0f, color);
+}
+
+static bool runBefore(const SpriteRun *a, const SpriteRun *b)
+{
+    if (a->layer != b->layer)
+        return a->layer < b->layer;
+    if (a->blend != b->blend)
+        return a->blend < b->blend;
+    return a->texture < b->texture;
+}
+
+void flushSpriteBatch(SpriteBatch *batch)
+{
+    if (batch->count == 0)
+        return;
+
+    // Counting sort of the quads by run: order the few runs, give each a
+    // slice of `order`, then scatter the quads in submission order
+    int sorted[SPRITE_BATCH_MAX_RUNS];
+    for (int i = 0; i < batch->runCount; i++)
+    {
+        int j = i;
+        for (; j > 0 && runBefore(&batch->runs[i], &batch->runs[sorted[j - 1]]); j--)
+            sorted[j] = sorted[j - 1];
+        sorted[j] = i;
+    }
+    int next[SPRITE_BATCH_MAX_RUNS];
+    for (int i = 0, start = 0; i < batch->runCount; i++)
+    {
+        SpriteRun *run = &batch->runs[sorted[i]];
+        run->start = next[sorted[i]] = start;
+        start += run->count;
+    }
+    for (int i = 0; i < batch->count; i++)
+        batch->order[next[batch->quads[i].run]++] = i;
+
+    // Flushes whatever the default batch holds, then collects into ours
+    rlSetRenderBatchActive(&batch->batch);
+    int blend = BLEND_ALPHA;
+    for (int r = 0; r < batch->runCount; r++)
+    {
+        const SpriteRun *run = &batch->runs[sorted[r]];
+        if (run->blend != blend)
+        {
+            // Submits the runs so far under the previous mode
+            BeginBlendMode(run->blend);
+            blend = run->blend;
+        }
+        rlSetTexture(run->texture);
+        rlBegin(RL_QUADS);
+        rlNormal3f(0.0f, 0.0f, 1.0f);
+        for (int i = run->start; i < run->start + run->count; i++)
+        {
+            const SpriteQuad *quad = &batch->quads[batch->order[i]];
+            // Draws the full buffer and carries on with this run's texture
+            if (rlCheckRenderBatchLimit(4))
+                batch->stats.drawCalls++;
+            rlColor4ub(quad->tint.r, quad->tint.g, quad->tint.b, quad->tint.a);
+            rlTexCoord2f(quad->u0, quad->v0);
+            rlVertex2f(quad->x, quad->y);
+            rlTexCoord2f(quad->u0, quad->v1);
+            rlVertex2f(quad->x, quad->y + quad->height);
+            rlTexCoord2f(quad->u1, quad->v1);
+            rlVertex2f(quad->x + quad->width, quad->y + quad->height);
+            rlTexCoord2f(quad->u1, quad->v0);
+            rlVertex2f(quad->x + quad->width, quad->y);
+        }
+        rlEnd();
+        batch->stats.drawCalls++;
+    }
+    rlSetTexture(0);
+    rlDrawRenderBatch(&batch->batch);
+    if (blend != BLEND_ALPHA)
+        EndBlendMode();
+    rlSetRenderBatchActive(NULL);
+
+    batch->stats.vertices += batch->count * 4;
+    batch->count = 0;
+    batch->runCount = 0;
+    batch->lastRun = -1;
+}
+
+SpriteBatchStats takeSpriteBatchStats(SpriteBatch *batch)
+{
+    SpriteBatchStats stats = batch->stats;
+    batch->stats = (SpriteBatchStats){0};
+    return stats;
+}
@@ -0,0 +1,79 @@
+#ifndef BREAKOUT_SPRITE_BATCH_H
+#define BREAKOUT_SPRITE_BATCH_H
+
+#include <stdint.h>
+
+#include "raylib.h"
+#include "rlgl.h"
+#include "sprite_atlas.h"
+
+// Distinct (layer, blend mode, texture) combinations per flush
+#define SPRITE_BATCH_MAX_RUNS 64
+// Quads per GPU submission. GLES2 indices are 16-bit, so one buffer can
+// address at most 65536 vertices.
+#define SPRITE_BATCH_GL_QUADS 16384
+
+typedef struct SpriteQuad
+{
+    float x, y, width, height;
+    float u0, v0, u1, v1;
+    Color tint;
+    int run;
+} SpriteQuad;
+
+// Quads sharing a layer, blend mode and texture; one draw call when submitted
+typedef struct SpriteRun
+{
+    int layer;
+    int blend;
+    unsigned int texture;
+    int count;
+    int start;
+} SpriteRun;
+
+typedef struct SpriteBatchStats
+{
+    int drawCalls;
+    int vertices;
+    int dropped;
+} SpriteBatchStats;
+
+// Collects textured quads for a frame and submits them sorted by layer, then
+// blend mode, then texture, through a dedicated rlgl batch of at most
+// SPRITE_BATCH_GL_QUADS quads, drawn in chunks when a flush holds more.
+// Lower layers draw first; within a layer quads sharing a blend mode and
+// texture keep their submission order, but different textures in the same
+// layer must not overlap. Quads past the capacity are dropped and counted.
+typedef struct SpriteBatch
+{
+    rlRenderBatch batch;
+    SpriteQuad *quads;
+    int *order;
+    int count;
+    int capacity;
+    SpriteRun runs[SPRITE_BATCH_MAX_RUNS];
+    int runCount;
+    int lastRun;
+    SpriteBatchStats stats;
+} SpriteBatch;
+
+// Needs the GL context, so call after InitWindow
+void initSpriteBatch(SpriteBatch *batch, int capacity);
+void unloadSpriteBatch(SpriteBatch *batch);
+
+void batchQuad(SpriteBatch *batch, int layer, int blend, unsigned int texture, Rectangle dest, float u0, float v0, float u1, float v1, Color tint);
+// Same placement and flipping as DrawTextureRec
+void batchTextureRec(SpriteBatch *batch, int layer, Texture2D texture, Rectangle src, Vector2 position, Color tint);
+void batchRectangle(SpriteBatch *batch, int layer, Rectangle rec, Color color);
+
+// Draws everything collected so far and empties the batch
+void flushSpriteBatch(SpriteBatch *batch);
+// Totals since the last call
+SpriteBatchStats takeSpriteBatchStats(SpriteBatch *batch);
+
+static inline void batchSpriteFrame(SpriteBatch *batch, int layer, Texture2D texture, const SpriteFrame *frame, float x, float y, Color tint)
+{
+    batchTextureRec(batch, layer, texture, frame->src, (Vector2){x + frame->offsetX, y + frame->offsetY}, tint);
+}
+
+#endif
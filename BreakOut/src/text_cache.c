@@ -0,0 +1,198 @@
+#include "text_cache.h"
+#include "rlgl.h"
+
+#include <stdio.h>
+#include <string.h>
+
+// DrawText's spacing for the default font
+#define DEFAULT_FONT_SIZE 10
+
+static uint32_t hashText(const char *text, int fontSize)
+{
+    uint32_t hash = 2166136261u ^ (uint32_t)fontSize;
+    for (const char *c = text; *c; c++)
+        hash = (hash ^ (unsigned char)*c) * 16777619u;
+    return hash;
+}
+
+static bool canLayout(const char *text)
+{
+    size_t length = 0;
+    for (; text[length]; length++)
+    {
+        if ((unsigned char)text[length] >= 0x80 || text[length] == '\n' || length + 1 >= TEXT_LAYOUT_MAX)
+            return false;
+    }
+    return true;
+}
+
+// Mirrors DrawText -> DrawTextEx -> DrawTextCodepoint for one line
+static void layoutText(const Font *font, TextLayout *layout, const char *text, int fontSize)
+{
+    size_t length = strlen(text);
+    if (fontSize < DEFAULT_FONT_SIZE)
+        fontSize = DEFAULT_FONT_SIZE;
+    float spacing = (float)(fontSize / DEFAULT_FONT_SIZE);
+    float scale = (float)fontSize / font->baseSize;
+    float padding = (float)font->glyphPadding;
+    float textureWidth = (float)font->texture.width;
+    float textureHeight = (float)font->texture.height;
+
+    memcpy(layout->text, text, length + 1);
+    layout->fontSize = fontSize;
+    layout->width = MeasureText(text, fontSize);
+    layout->quadCount = 0;
+    float offsetX = 0.0f;
+    for (size_t i = 0; i < length; i++)
+    {
+        int index = GetGlyphIndex(*font, (unsigned char)text[i]);
+        Rectangle rec = font->recs[index];
+        GlyphInfo glyph = font->glyphs[index];
+        if (text[i] != ' ' && text[i] != '\t')
+        {
+            TextQuad *quad = &layout->quads[layout->quadCount++];
+            quad->x = offsetX + glyph.offsetX * scale - padding * scale;
+            quad->y = glyph.offsetY * scale - padding * scale;
+            quad->width = (rec.width + 2.0f * padding) * scale;
+            quad->height = (rec.height + 2.0f * padding) * scale;
+            quad->u0 = (rec.x - padding) / textureWidth;
+            quad->v0 = (rec.y - padding) / textureHeight;
+            quad->u1 = (rec.x + rec.width + padding) / textureWidth;
+            quad->v1 = (rec.y + rec.height + padding) / textureHeight;
+        }
+        offsetX += (glyph.advanceX == 0 ? rec.width * scale : glyph.advanceX * scale) + spacing;
+    }
+}
+
+static void drawLayout(const Font *font, const TextLayout *layout, float x, float y, Color color)
+{
+    if (layout->quadCount == 0)
+        return;
+    rlCheckRenderBatchLimit(4 * layout->quadCount);
+    rlSetTexture(font->texture.id);
+    rlBegin(RL_QUADS);
+    rlColor4ub(color.r, color.g, color.b, color.a);
+    rlNormal3f(0.0f, 0.0f, 1.0f);
+    for (int i = 0; i < layout->quadCount; i++)
+    {
+        const TextQuad *quad = &layout->quads[i];
+        float left = x + quad->x;
+        float top = y + quad->y;
+        rlTexCoord2f(quad->u0, quad->v0);
+        rlVertex2f(left, top);
+        rlTexCoord2f(quad->u0, quad->v1);
+        rlVertex2f(left, top + quad->height);
+        rlTexCoord2f(quad->u1, quad->v1);
+        rlVertex2f(left + quad->width, top + quad->height);
+        rlTexCoord2f(quad->u1, quad->v0);
+        rlVertex2f(left + quad->width, top);
+    }
+    rlEnd();
+    rlSetTexture(0);
+}
+
+static void batchLayout(SpriteBatch *batch, int layer, const Font *font, const TextLayout *layout, float x, float y, Color color)
+{
+    for (int i = 0; i < layout->quadCount; i++)
+    {
+        const TextQuad *quad = &layout->quads[i];
+        Rectangle dest = {x + quad->x, y + quad->y, quad->width, quad->height};
+        batchQuad(batch, layer, BLEND_ALPHA, font->texture.id, dest, quad->u0, quad->v0, quad->u1, quad->v1, color);
+    }
+}
+
+void initTextCache(TextCache *cache)
+{
+    memset(cache, 0, sizeof(*cache));
+    cache->font = GetFontDefault();
+}
+
+// Open addressing over a small table; when the probe runs out the home slot
+// is simply replaced
+static const TextLayout *findLayout(TextCache *cache, const char *text, int fontSize)
+{
+    if (fontSize < DEFAULT_FONT_SIZE)
+        fontSize = DEFAULT_FONT_SIZE;
+    uint32_t hash = hashText(text, fontSize);
+    int home = hash % TEXT_CACHE_SIZE;
+    TextLayout *layout = &cache->entries[home];
+    for (int probe = 0; probe < 8; probe++)
+    {
+        TextLayout *slot = &cache->entries[(home + probe) % TEXT_CACHE_SIZE];
+        if (slot->fontSize == 0)
+        {
+            layout = slot;
+            break;
+        }
+        if (slot->hash == hash && slot->fontSize == fontSize && strcmp(slot->text, text) == 0)
+            return slot;
+    }
+    if (!canLayout(text))
+        return 0;
+    layoutText(&cache->font, layout, text, fontSize);
+    layout->hash = hash;
+    return layout;
+}
+
+int cachedTextWidth(TextCache *cache, const char *text, int fontSize)
+{
+    const TextLayout *layout = findLayout(cache, text, fontSize);
+    return layout ? layout->width : MeasureText(text, fontSize);
+}
+
+void drawCachedText(TextCache *cache, const char *text, int x, int y, int fontSize, Color color)
+{
+    const TextLayout *layout = findLayout(cache, text, fontSize);
+    if (layout)
+        drawLayout(&cache->font, layout, (float)x, (float)y, color);
+    else
+        DrawText(text, x, y, fontSize, color);
+}
+
+void drawCachedTextCentered(TextCache *cache, const char *text, int centerX, int y, int fontSize, Color color)
+{
+    const TextLayout *layout = findLayout(cache, text, fontSize);
+    if (layout)
+        drawLayout(&cache->font, layout, (float)(centerX - layout->width / 2), (float)y, color);
+    else
+        DrawText(text, centerX - MeasureText(text, fontSize) / 2, y, fontSize, color);
+}
+
+void initIntLabel(IntLabel *label, const char *format, int fontSize)
+{
+    label->format = format;
+    label->fontSize = fontSize;
+    label->value = 0;
+    label->valid = false;
+}
+
+// Formats are ours and single-line ASCII, and the result is truncated to
+// fit, so labels never need the DrawText fallback
+static void updateIntLabel(const TextCache *cache, IntLabel *label, int value)
+{
+    if (label->valid && label->value == value)
+        return;
+    char text[TEXT_LAYOUT_MAX];
+    snprintf(text, sizeof(text), label->format, value);
+    layoutText(&cache->font, &label->layout, text, label->fontSize);
+    label->value = value;
+    label->valid = true;
+}
+
+int intLabelWidth(const TextCache *cache, IntLabel *label, int value)
+{
+    updateIntLabel(cache, label, value);
+    return label->layout.width;
+}
+
+void drawIntLabel(const TextCache *cache, IntLabel *label, int value, int x, int y, Color color)
+{
+    updateIntLabel(cache, label, value);
+    drawLayout(&cache->font, &label->layout, (float)x, (float)y, color);
+}
+
+void batchIntLabel(SpriteBatch *batch, int layer, const TextCache *cache, IntLabel *label, int value, int x, int y, Color color)
+{
+    updateIntLabel(cache, label, value);
+    batchLayout(batch, layer, &cache->font, &label->layout, (float)x, (float)y, color);
+}
@@ -0,0 +1,64 @@
+#ifndef BREAKOUT_TEXT_CACHE_H
+#define BREAKOUT_TEXT_CACHE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "raylib.h"
+#include "sprite_batch.h"
+
+#define TEXT_LAYOUT_MAX 48
+#define TEXT_CACHE_SIZE 64
+
+// Glyph quad relative to the text origin, texture coordinates normalised
+typedef struct TextQuad
+{
+    float x, y, width, height;
+    float u0, v0, u1, v1;
+} TextQuad;
+
+// A single line of ASCII text laid out for the default font exactly as
+// DrawText would place it, plus the width MeasureText reports
+typedef struct TextLayout
+{
+    char text[TEXT_LAYOUT_MAX];
+    int fontSize;
+    int width;
+    int quadCount;
+    uint32_t hash;
+    TextQuad quads[TEXT_LAYOUT_MAX];
+} TextLayout;
+
+// Layouts of constant strings keyed on (text, font size). Lookups hash the
+// string instead of measuring it and drawing is one run of quads. Strings the
+// cache cannot hold (too long, multi-line or non-ASCII) fall back to DrawText.
+typedef struct TextCache
+{
+    Font font;
+    TextLayout entries[TEXT_CACHE_SIZE];
+} TextCache;
+
+// Text built from an integer, only laid out again when the value changes
+typedef struct IntLabel
+{
+    const char *format;
+    int fontSize;
+    int value;
+    bool valid;
+    TextLayout layout;
+} IntLabel;
+
+// Needs the default font, so call after InitWindow
+void initTextCache(TextCache *cache);
+int cachedTextWidth(TextCache *cache, const char *text, int fontSize);
+void drawCachedText(TextCache *cache, const char *text, int x, int y, int fontSize, Color color);
+// Horizontally centred on centerX
+void drawCachedTextCentered(TextCache *cache, const char *text, int centerX, int y, int fontSize, Color color);
+
+// format takes one int and must produce a single line of ASCII
+void initIntLabel(IntLabel *label, const char *format, int fontSize);
+int intLabelWidth(const TextCache *cache, IntLabel *label, int value);
+void drawIntLabel(const TextCache *cache, IntLabel *label, int value, int x, int y, Color color);
+void batchIntLabel(SpriteBatch *batch, int layer, const TextCache *cache, IntLabel *label, int value, int x, int y, Color color);
+
+#endif
@@ -0,0 +1,59 @@
+// Endless mode edge case: the last ball falls out in the same tick a row
+// with bricks left in it leaves the field. The run ends once, with no lives
+// below zero and no row fed in after the end.
+
+#include <stdio.h>
+
+#include "sim.h"
+
+int main(void)
+{
+    static GameState game;
+    initGameState(&game, 900, 550, 1);
+    game.setting.mode = MODE_ENDLESS;
+    // Menu, then the paddle screen
+    for (int i = 0; i < 2; i++)
+        stepGame(&game, (GameInput){INPUT_ENTER, INPUT_ENTER}, 1.0f / SIM_TICK_RATE);
+    if (game.state != PLAY || !game.endless)
+    {
+        printf("could not start an endless run\n");
+        return 1;
+    }
+
+    BrickField *bricks = &game.bricks;
+    int last = bricks->rows - 1;
+    bricks->live[last] = 1;
+    bricks->health[brickIndex(last, 0)] = BRICK_HEALTH;
+    bricks->liveCount++;
+    // Just short of the next row, which this tick's scroll would push in
+    bricks->top = -0.001f;
+    uint32_t rows = game.endlessRows;
+
+    // Last ball already past the bottom and on its last life
+    game.lives = 1;
+    game.balls.count = 1;
+    game.balls.x[0] = game.screenWidth / 2;
+    game.balls.y[0] = game.screenHeight + 4 * SPRITE_SIZE;
+    game.balls.speedX[0] = 0;
+    game.balls.speedY[0] = BALL_SPEED;
+
+    stepGame(&game, (GameInput){0, 0}, 1.0f / SIM_TICK_RATE);
+
+    int failures = 0;
+    if (game.state != GAMEOVER)
+    {
+        printf("state %d, expected GAMEOVER\n", game.state);
+        failures++;
+    }
+    if (game.lives != 0)
+    {
+        printf("lives %d, expected 0\n", game.lives);
+        failures++;
+    }
+    if (game.endlessRows != rows)
+    {
+        printf("%u rows fed in after the run ended\n", game.endlessRows - rows);
+        failures++;
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,60 @@
+// Pushes snapshots of mixed sizes through several wraps of a rewind ring and
+// pops them all back; every retained entry must load and they must come back
+// newest first with no gaps.
+
+#include <stdio.h>
+
+#include "snapshot.h"
+
+#define PUSHES 5000
+#define SLOTS 300
+
+int main(void)
+{
+    static GameState game;
+    initGameState(&game, 900, 550, 1);
+    RewindBuffer rewind;
+    if (!initRewindBuffer(&rewind, SLOTS, SLOTS * 512))
+    {
+        printf("could not allocate the rewind buffer\n");
+        return 1;
+    }
+
+    for (int i = 0; i < PUSHES; i++)
+    {
+        // Ball counts jump around like they do during multi-ball
+        BallSet *balls = &game.balls;
+        balls->count = 1 + (i * 7919) % (i % 3 == 0 ? MAX_BALLS : 16);
+        for (int b = 0; b < balls->count; b++)
+        {
+            balls->x[b] = (float)(b % 800);
+            balls->y[b] = (float)(i % 400);
+        }
+        game.score = i;
+        if (!pushRewind(&rewind, &game))
+        {
+            printf("push %d failed\n", i);
+            return 1;
+        }
+    }
+
+    int failures = 0;
+    int popped = 0;
+    int expected = PUSHES - 1;
+    while (rewind.count > 0)
+    {
+        if (!popRewind(&rewind, &game))
+            failures++;
+        else if (game.score != expected)
+        {
+            printf("popped score %d, expected %d\n", game.score, expected);
+            failures++;
+        }
+        expected--;
+        popped++;
+    }
+    unloadRewindBuffer(&rewind);
+
+    printf("%d entries popped, %d failures\n", popped, failures);
+    return failures == 0 && popped > 0 ? 0 : 1;
+}
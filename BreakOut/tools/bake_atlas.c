@@ -0,0 +1,236 @@
+// Offline sprite atlas baker. Cuts the frames BreakOut draws out of the
+// sprite sheet, trims their transparent borders, shelf-packs them into a
+// small atlas image and writes atlas_frames.h with the frame tables for both
+// the atlas and the original sheet.
+//
+//   bake_atlas <sheet.png> <atlas.png> <atlas_frames.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bricks.h"
+#include "raylib.h"
+#include "sim.h"
+
+// Empty pixels kept between packed frames
+#define ATLAS_PADDING 1
+#define FRAME_COUNT (PADDLE_TOTAL + BRICK_TIER * BRICK_HEALTH + 3)
+
+typedef struct Frame
+{
+    int x, y, width, height;       // untrimmed, in the sheet
+    int trimX, trimY, trimWidth, trimHeight; // trimmed, relative to the frame
+    int atlasX, atlasY;
+} Frame;
+
+static Frame sheetFrame(int x, int y, int width, int height)
+{
+    return (Frame){.x = x, .y = y, .width = width, .height = height};
+}
+
+// Where each frame lives in breakOutAssets.png, in SpriteAtlas field order
+static void listFrames(Frame *frames, int sheetWidth, int sheetHeight)
+{
+    int n = 0;
+    for (int skin = 0; skin < PADDLE_TOTAL; skin++)
+        frames[n++] = sheetFrame(255, sheetHeight - SPRITE_SIZE * (1 + skin), SPRITE_SIZE * 3, SPRITE_SIZE);
+    for (int tier = 0; tier < BRICK_TIER; tier++)
+    {
+        for (int health = 1; health <= BRICK_HEALTH; health++)
+        {
+            int column = BRICK_HEALTH - health;
+            frames[n++] = sheetFrame(sheetWidth - BRICK_WIDTH * BRICK_TIER + BRICK_WIDTH * column, BRICK_HEIGHT * tier, BRICK_WIDTH, BRICK_HEIGHT);
+        }
+    }
+    frames[n++] = sheetFrame(704, 352, SPRITE_SIZE, SPRITE_SIZE);
+    frames[n++] = sheetFrame(704, 352 + SPRITE_SIZE * 2, SPRITE_SIZE, SPRITE_SIZE);
+    frames[n++] = sheetFrame(383, sheetHeight - SPRITE_SIZE, SPRITE_SIZE, SPRITE_SIZE);
+}
+
+static void trimFrame(Frame *frame, const unsigned char *pixels, int sheetWidth)
+{
+    int left = frame->width, top = frame->height, right = -1, bottom = -1;
+    for (int y = 0; y < frame->height; y++)
+    {
+        const unsigned char *row = pixels + ((size_t)(frame->y + y) * sheetWidth + frame->x) * 4;
+        for (int x = 0; x < frame->width; x++)
+        {
+            if (row[x * 4 + 3] == 0)
+                continue;
+            left = x < left ? x : left;
+            right = x > right ? x : right;
+            top = y < top ? y : top;
+            bottom = y > bottom ? y : bottom;
+        }
+    }
+    if (right < 0)
+    {
+        frame->trimX = frame->trimY = frame->trimWidth = frame->trimHeight = 0;
+        return;
+    }
+    frame->trimX = left;
+    frame->trimY = top;
+    frame->trimWidth = right - left + 1;
+    frame->trimHeight = bottom - top + 1;
+}
+
+static int byHeight(const void *a, const void *b)
+{
+    const Frame *fa = *(const Frame *const *)a;
+    const Frame *fb = *(const Frame *const *)b;
+    if (fa->trimHeight != fb->trimHeight)
+        return fb->trimHeight - fa->trimHeight;
+    return fb->trimWidth - fa->trimWidth;
+}
+
+// Shelf packing, tallest first; returns the height used or -1 if a frame is
+// wider than the atlas
+static int packShelves(Frame **sorted, int count, int width)
+{
+    int x = 0, y = 0, shelf = 0;
+    for (int i = 0; i < count; i++)
+    {
+        Frame *frame = sorted[i];
+        if (frame->trimWidth + ATLAS_PADDING > width)
+            return -1;
+        if (x + frame->trimWidth + ATLAS_PADDING > width)
+        {
+            y += shelf;
+            x = 0;
+            shelf = 0;
+        }
+        frame->atlasX = x;
+        frame->atlasY = y;
+        x += frame->trimWidth + ATLAS_PADDING;
+        if (frame->trimHeight + ATLAS_PADDING > shelf)
+            shelf = frame->trimHeight + ATLAS_PADDING;
+    }
+    return y + shelf;
+}
+
+static void writeFrame(FILE *out, const char *indent, int x, int y, int width, int height, int offsetX, int offsetY)
+{
+    fprintf(out, "%s{{%d, %d, %d, %d}, %d, %d},\n", indent, x, y, width, height, offsetX, offsetY);
+}
+
+static void writeAtlas(FILE *out, const char *name, const char *asset, const Frame *frames, bool packed)
+{
+    fprintf(out, "static const SpriteAtlas %s = {\n    \"%s\",\n", name, asset);
+    int n = 0;
+    for (int group = 0; group < 5; group++)
+    {
+        int count = group == 0 ? PADDLE_TOTAL : group == 1 ? BRICK_TIER * BRICK_HEALTH : 1;
+        if (count > 1)
+            fprintf(out, "    {\n");
+        for (int i = 0; i < count; i++, n++)
+        {
+            const Frame *f = &frames[n];
+            const char *indent = count > 1 ? "        " : "    ";
+            if (group == 1 && i % BRICK_HEALTH == 0)
+                fprintf(out, "        {\n");
+            if (group == 1)
+                indent = "            ";
+            if (packed)
+                writeFrame(out, indent, f->atlasX, f->atlasY, f->trimWidth, f->trimHeight, f->trimX, f->trimY);
+            else
+                writeFrame(out, indent, f->x, f->y, f->width, f->height, 0, 0);
+            if (group == 1 && i % BRICK_HEALTH == BRICK_HEALTH - 1)
+                fprintf(out, "        },\n");
+        }
+        if (count > 1)
+            fprintf(out, "    },\n");
+    }
+    fprintf(out, "};\n");
+}
+
+int main(int argc, char **argv)
+{
+    if (argc != 4)
+    {
+        printf("usage: %s <sheet.png> <atlas.png> <atlas_frames.h>\n", argv[0]);
+        return 2;
+    }
+    SetTraceLogLevel(LOG_WARNING);
+    Image sheet = LoadImage(argv[1]);
+    if (!sheet.data)
+    {
+        printf("Could not load %s\n", argv[1]);
+        return 1;
+    }
+    ImageFormat(&sheet, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+    const unsigned char *pixels = sheet.data;
+
+    Frame frames[FRAME_COUNT];
+    Frame *sorted[FRAME_COUNT];
+    listFrames(frames, sheet.width, sheet.height);
+    for (int i = 0; i < FRAME_COUNT; i++)
+    {
+        if (frames[i].x < 0 || frames[i].y < 0 || frames[i].x + frames[i].width > sheet.width || frames[i].y + frames[i].height > sheet.height)
+        {
+            printf("Frame %d lies outside the %dx%d sheet\n", i, sheet.width, sheet.height);
+            UnloadImage(sheet);
+            return 1;
+        }
+        trimFrame(&frames[i], pixels, sheet.width);
+        sorted[i] = &frames[i];
+    }
+    qsort(sorted, FRAME_COUNT, sizeof(sorted[0]), byHeight);
+
+    // Smallest area over power-of-two widths
+    int bestWidth = 0, bestHeight = 0;
+    for (int width = 64; width <= 2048; width *= 2)
+    {
+        int height = packShelves(sorted, FRAME_COUNT, width);
+        if (height > 0 && (!bestWidth || (long)width * height < (long)bestWidth * bestHeight))
+        {
+            bestWidth = width;
+            bestHeight = height;
+        }
+    }
+    if (!bestWidth)
+    {
+        printf("Frames do not fit in a 2048 wide atlas\n");
+        UnloadImage(sheet);
+        return 1;
+    }
+    packShelves(sorted, FRAME_COUNT, bestWidth);
+
+    Image atlas = GenImageColor(bestWidth, bestHeight, BLANK);
+    ImageFormat(&atlas, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+    unsigned char *atlasPixels = atlas.data;
+    for (int i = 0; i < FRAME_COUNT; i++)
+    {
+        const Frame *f = &frames[i];
+        for (int y = 0; y < f->trimHeight; y++)
+        {
+            const unsigned char *from = pixels + ((size_t)(f->y + f->trimY + y) * sheet.width + f->x + f->trimX) * 4;
+            memcpy(atlasPixels + ((size_t)(f->atlasY + y) * bestWidth + f->atlasX) * 4, from, (size_t)f->trimWidth * 4);
+        }
+    }
+    bool ok = ExportImage(atlas, argv[2]);
+    UnloadImage(atlas);
+    UnloadImage(sheet);
+    if (!ok)
+    {
+        printf("Could not write %s\n", argv[2]);
+        return 1;
+    }
+
+    FILE *out = fopen(argv[3], "w");
+    if (!out)
+    {
+        printf("Could not write %s\n", argv[3]);
+        return 1;
+    }
+    fprintf(out, "// Generated by bake_atlas, do not edit\n");
+    fprintf(out, "#ifndef BREAKOUT_ATLAS_FRAMES_H\n#define BREAKOUT_ATLAS_FRAMES_H\n\n#include \"sprite_atlas.h\"\n\n");
+    fprintf(out, "#define ATLAS_WIDTH %d\n#define ATLAS_HEIGHT %d\n\n", bestWidth, bestHeight);
+    writeAtlas(out, "packedAtlas", "sprites/atlas.png", frames, true);
+    fprintf(out, "\n// The whole sheet, for running without the asset pack\n");
+    writeAtlas(out, "sheetAtlas", "sprites/breakOutAssets.png", frames, false);
+    fprintf(out, "\n#endif\n");
+    ok = fclose(out) == 0;
+    printf("Baked %d frames into a %dx%d atlas\n", FRAME_COUNT, bestWidth, bestHeight);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,219 @@
+// Monte Carlo difficulty study. Plays thousands of headless sessions across
+// starting levels, paddle skins and seeds on a work-stealing pool. Each
+// session starts on the SETTING screen and is played by the scripted bot
+// until GAMEOVER or until it has cleared --max-levels levels. Every worker
+// aggregates into its own slot; the slots are merged once the pool is done.
+//
+//   montecarlo [--threads N] [--seeds N] [--levels N] [--max-levels N]
+//              [--reaction TICKS] [--seed S]
+
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 199309L
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "bot.h"
+#include "job_pool.h"
+#include "memtrack.h"
+#include "sim.h"
+
+#define MC_MAX_LEVELS 16
+#define MC_CELLS (MC_MAX_LEVELS * PADDLE_TOTAL)
+#define MC_SCORE_BUCKET 5
+#define MC_SCORE_BUCKETS 1024
+// Give up on a session after this much simulated play
+#define MC_TICK_LIMIT (SIM_TICK_RATE * 60 * 30)
+
+typedef struct CellStats
+{
+    long long runs;
+    long long victories;
+    long long timeouts;
+    long long levelsCleared;
+    long long livesLost;
+    long long ticks;
+    long long scoreSum;
+    int scoreHistogram[MC_SCORE_BUCKETS];
+} CellStats;
+
+// One per worker, aligned so neighbouring workers never share a cache line
+typedef struct WorkerStats
+{
+    _Alignas(64) CellStats cells[MC_CELLS];
+    long long ticks;
+} WorkerStats;
+
+typedef struct Study
+{
+    int levels;
+    int seeds;
+    int maxLevels;
+    int reaction;
+    uint64_t baseSeed;
+    WorkerStats *workers;
+} Study;
+
+// Bot with a reaction delay: it only looks at the game every `reaction` ticks
+// and keeps holding the same keys in between
+static GameInput sluggishBot(const GameState *game, unsigned int tick, int reaction, GameInput *held)
+{
+    if (tick % reaction == 0)
+    {
+        *held = botInput(game, tick / reaction);
+        return *held;
+    }
+    return (GameInput){held->down, 0};
+}
+
+static void runSession(void *context, int64_t index, int worker)
+{
+    Study *study = context;
+    int cell = (int)(index / study->seeds);
+    int level = 1 + cell / PADDLE_TOTAL;
+    int paddle = cell % PADDLE_TOTAL;
+
+    GameState game;
+    initGameState(&game, 900, 550, study->baseSeed + (uint64_t)index);
+    game.state = SETTING;
+    game.level = level;
+    game.setting.paddle = paddle;
+
+    const float dt = 1.0f / SIM_TICK_RATE;
+    GameInput held = {0, 0};
+    int cleared = 0;
+    int lives = game.lives;
+    unsigned int tick = 0;
+    while (tick < MC_TICK_LIMIT)
+    {
+        stepGame(&game, sluggishBot(&game, tick, study->reaction, &held), dt);
+        tick++;
+        if (game.state == GAMEOVER)
+            break;
+        if (game.events & EVENT_VICTORY && ++cleared >= study->maxLevels)
+            break;
+    }
+
+    WorkerStats *stats = &study->workers[worker];
+    CellStats *c = &stats->cells[cell];
+    int bucket = game.score / MC_SCORE_BUCKET;
+    c->runs++;
+    c->victories += game.state != GAMEOVER && tick < MC_TICK_LIMIT;
+    c->timeouts += tick >= MC_TICK_LIMIT;
+    c->levelsCleared += cleared;
+    c->livesLost += lives - game.lives;
+    c->ticks += tick;
+    c->scoreSum += game.score;
+    c->scoreHistogram[bucket < MC_SCORE_BUCKETS ? bucket : MC_SCORE_BUCKETS - 1]++;
+    stats->ticks += tick;
+}
+
+static void mergeCell(CellStats *into, const CellStats *from)
+{
+    into->runs += from->runs;
+    into->victories += from->victories;
+    into->timeouts += from->timeouts;
+    into->levelsCleared += from->levelsCleared;
+    into->livesLost += from->livesLost;
+    into->ticks += from->ticks;
+    into->scoreSum += from->scoreSum;
+    for (int b = 0; b < MC_SCORE_BUCKETS; b++)
+        into->scoreHistogram[b] += from->scoreHistogram[b];
+}
+
+static int scorePercentile(const CellStats *cell, double fraction)
+{
+    long long target = (long long)(cell->runs * fraction);
+    long long seen = 0;
+    for (int b = 0; b < MC_SCORE_BUCKETS; b++)
+    {
+        seen += cell->scoreHistogram[b];
+        if (seen > target)
+            return b * MC_SCORE_BUCKET;
+    }
+    return (MC_SCORE_BUCKETS - 1) * MC_SCORE_BUCKET;
+}
+
+static double seconds(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+int main(int argc, char **argv)
+{
+    int threads = 0;
+    Study study = {8, 256, 1, 24, 1, 0};
+    for (int i = 1; i + 1 < argc; i++)
+    {
+        if (strcmp(argv[i], "--threads") == 0)
+            threads = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--seeds") == 0)
+            study.seeds = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--levels") == 0)
+            study.levels = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--max-levels") == 0)
+            study.maxLevels = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--reaction") == 0)
+            study.reaction = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--seed") == 0)
+            study.baseSeed = strtoull(argv[++i], 0, 10);
+    }
+    if (study.levels < 1 || study.levels > MC_MAX_LEVELS)
+        study.levels = MC_MAX_LEVELS;
+    if (study.seeds < 1)
+        study.seeds = 1;
+    if (study.reaction < 1)
+        study.reaction = 1;
+    if (study.maxLevels < 1)
+        study.maxLevels = 1;
+
+    JobPool *pool = createJobPool(threads);
+    if (!pool)
+    {
+        printf("Could not start the worker threads\n");
+        return 1;
+    }
+    int workers = jobPoolWorkers(pool);
+    study.workers = memAlignedAlloc(sizeof(WorkerStats) * workers, _Alignof(WorkerStats), MEM_JOBS);
+    if (!study.workers)
+    {
+        destroyJobPool(pool);
+        return 1;
+    }
+    memset(study.workers, 0, sizeof(WorkerStats) * workers);
+
+    int64_t sessions = (int64_t)study.levels * PADDLE_TOTAL * study.seeds;
+    double start = seconds();
+    jobPoolRun(pool, sessions, 1, runSession, &study);
+    double elapsed = seconds() - start;
+    destroyJobPool(pool);
+
+    CellStats total = {0};
+    long long ticks = 0;
+    for (int w = 0; w < workers; w++)
+        ticks += study.workers[w].ticks;
+
+    printf("%lld sessions on %d threads in %.2f s: %.0f sessions/s, %.3g ticks/s\n\n", (long long)sessions, workers, elapsed, sessions / elapsed, ticks / elapsed);
+    printf("level paddle   runs  clear%%  levels  score p10/p50/p90  s/life\n");
+    for (int cell = 0; cell < study.levels * PADDLE_TOTAL; cell++)
+    {
+        CellStats merged = {0};
+        for (int w = 0; w < workers; w++)
+            mergeCell(&merged, &study.workers[w].cells[cell]);
+        mergeCell(&total, &merged);
+
+        double perLife = merged.livesLost ? (double)merged.ticks / merged.livesLost / SIM_TICK_RATE : 0;
+        printf("%5d %6d %6lld %6.1f%% %7.2f  %5d/%5d/%5d  %6.1f\n", 1 + cell / PADDLE_TOTAL, cell % PADDLE_TOTAL, merged.runs,
+               100.0 * merged.victories / merged.runs, (double)merged.levelsCleared / merged.runs,
+               scorePercentile(&merged, 0.1), scorePercentile(&merged, 0.5), scorePercentile(&merged, 0.9), perLife);
+    }
+    printf("\nall: clear %.1f%%, mean score %.1f, timeouts %lld\n", 100.0 * total.victories / total.runs, (double)total.scoreSum / total.runs, total.timeouts);
+
+    memAlignedFree(study.workers);
+    return 0;
+}
@@ -0,0 +1,107 @@
+// Offline asset packer. Decodes images to RGBA8 pixels and sounds to PCM with
+// raylib's own loaders and stores the results in one aligned archive, so the
+// game can create textures and sounds straight from a mapping of it.
+//
+//   pack_assets <out.pak> <resource dir> <name>...
+//
+// Names are paths under the resource dir and become the asset names; a
+// name=path argument packs a file from elsewhere, such as a generated one,
+// under that name. .png files are packed as images, .wav files as waves.
+
+#include <stdio.h>
+#include <string.h>
+
+#include "asset_pack.h"
+#include "raylib.h"
+
+int main(int argc, char **argv)
+{
+    if (argc < 4)
+    {
+        printf("usage: %s <out.pak> <resource dir> <name>...\n", argv[0]);
+        return 2;
+    }
+    int count = argc - 3;
+    if (count > ASSET_PACK_MAX_ENTRIES)
+    {
+        printf("At most %d assets per pack\n", ASSET_PACK_MAX_ENTRIES);
+        return 2;
+    }
+    SetTraceLogLevel(LOG_WARNING);
+
+    static AssetEntry entries[ASSET_PACK_MAX_ENTRIES];
+    static const void *data[ASSET_PACK_MAX_ENTRIES];
+    static Image images[ASSET_PACK_MAX_ENTRIES];
+    static Wave waves[ASSET_PACK_MAX_ENTRIES];
+    bool ok = true;
+    for (int i = 0; ok && i < count; i++)
+    {
+        const char *name = argv[3 + i];
+        const char *source = strchr(name, '=');
+        size_t nameLength = source ? (size_t)(source - name) : strlen(name);
+        AssetEntry *entry = &entries[i];
+        if (nameLength >= ASSET_NAME_MAX)
+        {
+            printf("Asset name too long: %s\n", name);
+            ok = false;
+            break;
+        }
+        memcpy(entry->name, name, nameLength);
+
+        char path[1024];
+        if (source)
+            snprintf(path, sizeof(path), "%s", source + 1);
+        else
+            snprintf(path, sizeof(path), "%s/%s", argv[2], name);
+        const char *extension = strrchr(path, '.');
+        if (extension && strcmp(extension, ".png") == 0)
+        {
+            images[i] = LoadImage(path);
+            ok = images[i].data != 0;
+            if (ok)
+            {
+                ImageFormat(&images[i], PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+                entry->type = ASSET_IMAGE;
+                entry->params[0] = (uint32_t)images[i].width;
+                entry->params[1] = (uint32_t)images[i].height;
+                entry->params[2] = 1;
+                entry->params[3] = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8;
+                entry->size = (uint64_t)images[i].width * images[i].height * 4;
+                data[i] = images[i].data;
+            }
+        }
+        else if (extension && strcmp(extension, ".wav") == 0)
+        {
+            waves[i] = LoadWave(path);
+            ok = waves[i].data != 0;
+            if (ok)
+            {
+                entry->type = ASSET_WAVE;
+                entry->params[0] = waves[i].frameCount;
+                entry->params[1] = waves[i].sampleRate;
+                entry->params[2] = waves[i].sampleSize;
+                entry->params[3] = waves[i].channels;
+                entry->size = (uint64_t)waves[i].frameCount * waves[i].channels * (waves[i].sampleSize / 8);
+                data[i] = waves[i].data;
+            }
+        }
+        else
+            ok = false;
+        if (!ok)
+            printf("Could not pack %s\n", path);
+    }
+
+    if (ok && !writeAssetPack(argv[1], entries, data, count))
+    {
+        printf("Could not write %s\n", argv[1]);
+        ok = false;
+    }
+    for (int i = 0; i < count; i++)
+    {
+        if (images[i].data)
+            UnloadImage(images[i]);
+        if (waves[i].data)
+            UnloadWave(waves[i]);
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,53 @@
+// Headless fast-forward of a BreakOut replay. Steps every recorded tick as
+// fast as the CPU allows and compares the final state hash with the one
+// stored in the file. Exits non-zero on a mismatch.
+//
+//   replay_check session.brpl [--repeat N]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "replay.h"
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        printf("usage: %s <replay> [--repeat N]\n", argv[0]);
+        return 2;
+    }
+    int repeat = 1;
+    for (int i = 2; i + 1 < argc; i++)
+    {
+        if (strcmp(argv[i], "--repeat") == 0)
+            repeat = atoi(argv[++i]);
+    }
+
+    Replay replay;
+    if (!loadReplay(&replay, argv[1]))
+    {
+        printf("Could not load replay %s\n", argv[1]);
+        return 2;
+    }
+
+    GameState game;
+    uint64_t hash = 0;
+    clock_t start = clock();
+    for (int r = 0; r < repeat; r++)
+        hash = runReplay(&replay, &game);
+    double seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    double ticks = (double)replay.tickCount * repeat;
+    printf("ticks:    %d (%.1f s of play at %d Hz)\n", replay.tickCount, (double)replay.tickCount / replay.tickRate, replay.tickRate);
+    printf("speed:    %.0f ticks/s\n", seconds > 0 ? ticks / seconds : 0.0);
+    printf("level %d, score %d, lives %d\n", game.level, game.score, game.lives);
+    printf("expected: %016llx\n", (unsigned long long)replay.finalHash);
+    printf("actual:   %016llx\n", (unsigned long long)hash);
+
+    bool match = hash == replay.finalHash;
+    printf("%s\n", match ? "OK" : "MISMATCH");
+    unloadReplay(&replay);
+    return match ? 0 : 1;
+}
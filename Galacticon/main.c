@@ -20,6 +20,8 @@
  ********************************************************************************************/
 
 #include "raylib.h"
+#include "profiler.h"
+#include "memtrack.h"
 
 //----------------------------------------------------------------------------------
 // Local Variables Definition (local to this module)
@@ -35,7 +37,7 @@ static void UpdateDrawFrame(void); // Update and draw one frame
 //----------------------------------------------------------------------------------
 // Main entry point
 //----------------------------------------------------------------------------------
-int main()
+int main(int argc, char **argv)
 {
     // Initialization
     //--------------------------------------------------------------------------------------
@@ -44,6 +46,14 @@ int main()
 
     InitWindow(screenWidth, screenHeight, "raylib");
 
+    const char *profileCsv = 0;
+    for (int i = 1; i + 1 < argc; i++)
+    {
+        if (TextIsEqual(argv[i], "--profile-csv"))
+            profileCsv = argv[++i];
+    }
+    profilerInit(profileCsv);
+
     camera.position = (Vector3){10.0f, 10.0f, 8.0f};
     camera.target = (Vector3){0.0f, 0.0f, 0.0f};
     camera.up = (Vector3){0.0f, 1.0f, 0.0f};
@@ -64,7 +74,9 @@ int main()
 
     // De-Initialization
     //--------------------------------------------------------------------------------------
+    profilerShutdown();
     CloseWindow(); // Close window and OpenGL context
+    memtrackReportLeaks(stderr);
     //--------------------------------------------------------------------------------------
 
     return 0;
@@ -75,11 +87,21 @@ static void UpdateDrawFrame(void)
 {
     // Update
     //----------------------------------------------------------------------------------
+    PROFILE_BEGIN(PHASE_INPUT);
+    if (IsKeyPressed(KEY_F3))
+        profilerToggleOverlay();
+    if (IsKeyPressed(KEY_F4))
+        memtrackToggleOverlay();
+    PROFILE_END(PHASE_INPUT);
+
+    PROFILE_BEGIN(PHASE_PHYSICS);
     UpdateCamera(&camera);
+    PROFILE_END(PHASE_PHYSICS);
     //----------------------------------------------------------------------------------
 
     // Draw
     //----------------------------------------------------------------------------------
+    PROFILE_BEGIN(PHASE_DRAW);
     BeginDrawing();
 
     ClearBackground(RAYWHITE);
@@ -95,7 +117,14 @@ static void UpdateDrawFrame(void)
     DrawText("This is a raylib example", 10, 40, 20, DARKGRAY);
 
     DrawFPS(10, 10);
+    drawProfilerOverlay(10, 70);
+    drawMemtrackOverlay(GetScreenWidth() - 350, 10);
+    PROFILE_END(PHASE_DRAW);
 
+    PROFILE_BEGIN(PHASE_PRESENT);
     EndDrawing();
+    PROFILE_END(PHASE_PRESENT);
+    PROFILE_END_FRAME();
+    memtrackEndFrame();
     //----------------------------------------------------------------------------------
 }
\ No newline at end of file
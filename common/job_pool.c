@@ -0,0 +1,290 @@
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "job_pool.h"
+#include "memtrack.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+// Deque slots hold a packed range, start in the high half and length in the
+// low half. Splitting in halves keeps a deque at most about 2 * log2(count)
+// deep, so a small fixed ring never wraps in practice; a failed push just
+// runs the range in place.
+#define DEQUE_CAPACITY 256
+#define CACHE_LINE 64
+
+typedef struct JobDeque
+{
+    _Alignas(CACHE_LINE) atomic_int_fast64_t top;
+    _Alignas(CACHE_LINE) atomic_int_fast64_t bottom;
+    atomic_uint_fast64_t items[DEQUE_CAPACITY];
+} JobDeque;
+
+typedef struct Worker
+{
+    JobDeque deque;
+    JobPool *pool;
+    int index;
+    uint32_t victimSeed;
+    pthread_t thread;
+} Worker;
+
+struct JobPool
+{
+    int workerCount;
+    Worker *workers;
+
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    pthread_cond_t finished;
+    uint64_t generation;
+    int active;
+    bool quit;
+
+    JobFunc func;
+    void *context;
+    int64_t grain;
+    _Alignas(CACHE_LINE) atomic_int_fast64_t remaining;
+};
+
+static uint64_t packRange(int64_t start, int64_t length)
+{
+    return ((uint64_t)start << 32) | (uint64_t)length;
+}
+
+static void unpackRange(uint64_t item, int64_t *start, int64_t *length)
+{
+    *start = (int64_t)(item >> 32);
+    *length = (int64_t)(item & 0xffffffffu);
+}
+
+// Chase-Lev deque: the owner pushes and pops at the bottom, thieves take from
+// the top, and only the last item needs a CAS to settle the race between them
+static bool pushJob(JobDeque *deque, uint64_t item)
+{
+    int64_t bottom = atomic_load_explicit(&deque->bottom, memory_order_relaxed);
+    int64_t top = atomic_load_explicit(&deque->top, memory_order_acquire);
+    if (bottom - top >= DEQUE_CAPACITY)
+        return false;
+    atomic_store_explicit(&deque->items[bottom % DEQUE_CAPACITY], item, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_relaxed);
+    return true;
+}
+
+static bool popJob(JobDeque *deque, uint64_t *item)
+{
+    int64_t bottom = atomic_load_explicit(&deque->bottom, memory_order_relaxed) - 1;
+    atomic_store_explicit(&deque->bottom, bottom, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    int64_t top = atomic_load_explicit(&deque->top, memory_order_relaxed);
+    if (top > bottom)
+    {
+        atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_relaxed);
+        return false;
+    }
+    *item = atomic_load_explicit(&deque->items[bottom % DEQUE_CAPACITY], memory_order_relaxed);
+    if (top == bottom)
+    {
+        bool won = atomic_compare_exchange_strong_explicit(&deque->top, &top, top + 1, memory_order_seq_cst, memory_order_relaxed);
+        atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_relaxed);
+        return won;
+    }
+    return true;
+}
+
+static bool stealJob(JobDeque *deque, uint64_t *item)
+{
+    int64_t top = atomic_load_explicit(&deque->top, memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    int64_t bottom = atomic_load_explicit(&deque->bottom, memory_order_acquire);
+    if (top >= bottom)
+        return false;
+    *item = atomic_load_explicit(&deque->items[top % DEQUE_CAPACITY], memory_order_relaxed);
+    return atomic_compare_exchange_strong_explicit(&deque->top, &top, top + 1, memory_order_seq_cst, memory_order_relaxed);
+}
+
+static bool findJob(Worker *worker, uint64_t *item)
+{
+    if (popJob(&worker->deque, item))
+        return true;
+    JobPool *pool = worker->pool;
+    if (pool->workerCount < 2)
+        return false;
+    // One pass over the other workers from a random starting point
+    worker->victimSeed ^= worker->victimSeed << 13;
+    worker->victimSeed ^= worker->victimSeed >> 17;
+    worker->victimSeed ^= worker->victimSeed << 5;
+    int first = worker->victimSeed % pool->workerCount;
+    for (int i = 0; i < pool->workerCount; i++)
+    {
+        int victim = (first + i) % pool->workerCount;
+        if (victim != worker->index && stealJob(&pool->workers[victim].deque, item))
+            return true;
+    }
+    return false;
+}
+
+static void runRange(Worker *worker, int64_t start, int64_t length)
+{
+    JobPool *pool = worker->pool;
+    // Hand the upper half back to the deque until the range is small enough
+    while (length > pool->grain && pushJob(&worker->deque, packRange(start + length / 2, length - length / 2)))
+        length /= 2;
+    for (int64_t i = start; i < start + length; i++)
+        pool->func(pool->context, i, worker->index);
+    atomic_fetch_sub_explicit(&pool->remaining, length, memory_order_acq_rel);
+}
+
+static void *workerMain(void *arg)
+{
+    Worker *worker = arg;
+    JobPool *pool = worker->pool;
+    uint64_t seen = 0;
+    for (;;)
+    {
+        pthread_mutex_lock(&pool->lock);
+        while (!pool->quit && pool->generation == seen)
+            pthread_cond_wait(&pool->wake, &pool->lock);
+        if (pool->quit)
+        {
+            pthread_mutex_unlock(&pool->lock);
+            return 0;
+        }
+        seen = pool->generation;
+        pool->active++;
+        pthread_mutex_unlock(&pool->lock);
+
+        int idle = 0;
+        while (atomic_load_explicit(&pool->remaining, memory_order_acquire) > 0)
+        {
+            uint64_t item;
+            if (findJob(worker, &item))
+            {
+                int64_t start, length;
+                unpackRange(item, &start, &length);
+                runRange(worker, start, length);
+                idle = 0;
+            }
+            else if (++idle > 64)
+                sched_yield();
+        }
+
+        pthread_mutex_lock(&pool->lock);
+        if (--pool->active == 0)
+            pthread_cond_signal(&pool->finished);
+        pthread_mutex_unlock(&pool->lock);
+    }
+}
+
+JobPool *createJobPool(int workers)
+{
+    if (workers <= 0)
+        workers = hardwareThreads();
+    if (workers > JOB_POOL_MAX_WORKERS)
+        workers = JOB_POOL_MAX_WORKERS;
+
+    // Both hold cache-line aligned counters, more than malloc guarantees
+    JobPool *pool = memAlignedAlloc(sizeof(JobPool), CACHE_LINE, MEM_JOBS);
+    if (!pool)
+        return 0;
+    memset(pool, 0, sizeof(JobPool));
+    pool->workers = memAlignedAlloc(sizeof(Worker) * workers, CACHE_LINE, MEM_JOBS);
+    if (!pool->workers)
+    {
+        memAlignedFree(pool);
+        return 0;
+    }
+    pool->workerCount = workers;
+    pthread_mutex_init(&pool->lock, 0);
+    pthread_cond_init(&pool->wake, 0);
+    pthread_cond_init(&pool->finished, 0);
+    for (int i = 0; i < workers; i++)
+    {
+        Worker *worker = &pool->workers[i];
+        atomic_init(&worker->deque.top, 0);
+        atomic_init(&worker->deque.bottom, 0);
+        worker->pool = pool;
+        worker->index = i;
+        worker->victimSeed = 0x9E3779B9u * (i + 1);
+    }
+    for (int i = 0; i < workers; i++)
+    {
+        if (pthread_create(&pool->workers[i].thread, 0, workerMain, &pool->workers[i]) != 0)
+        {
+            // Run with the threads that did start
+            pool->workerCount = i;
+            break;
+        }
+    }
+    if (pool->workerCount == 0)
+    {
+        destroyJobPool(pool);
+        return 0;
+    }
+    return pool;
+}
+
+void destroyJobPool(JobPool *pool)
+{
+    pthread_mutex_lock(&pool->lock);
+    pool->quit = true;
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+    for (int i = 0; i < pool->workerCount; i++)
+        pthread_join(pool->workers[i].thread, 0);
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->wake);
+    pthread_cond_destroy(&pool->finished);
+    memAlignedFree(pool->workers);
+    memAlignedFree(pool);
+}
+
+int jobPoolWorkers(const JobPool *pool)
+{
+    return pool->workerCount;
+}
+
+// Runs func for every index in [0, count) and returns once all are done.
+// grain is the largest range a worker runs without splitting it further.
+void jobPoolRun(JobPool *pool, int64_t count, int64_t grain, JobFunc func, void *context)
+{
+    if (count <= 0)
+        return;
+    pthread_mutex_lock(&pool->lock);
+    pool->func = func;
+    pool->context = context;
+    pool->grain = grain > 0 ? grain : 1;
+    atomic_store(&pool->remaining, count);
+    // No worker touches a deque without first joining the run under the
+    // lock, and the last run ended with none active, so seeding is safe here
+    pushJob(&pool->workers[0].deque, packRange(0, count));
+    pool->generation++;
+    pthread_cond_broadcast(&pool->wake);
+    while (atomic_load(&pool->remaining) > 0 || pool->active > 0)
+        pthread_cond_wait(&pool->finished, &pool->lock);
+    pthread_mutex_unlock(&pool->lock);
+}
+
+int hardwareThreads(void)
+{
+#if defined(_WIN32)
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return (int)info.dwNumberOfProcessors;
+#else
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (int)count : 1;
+#endif
+}
@@ -0,0 +1,25 @@
+#ifndef JOB_POOL_H
+#define JOB_POOL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Work-stealing pool for running many independent jobs across every core.
+// jobPoolRun hands the index range [0, count) to the workers as one task;
+// a worker splits whatever range it holds, keeps one half and leaves the
+// other on its own deque where idle workers can steal it. Each job is told
+// which worker runs it so results can go to per-worker storage.
+
+#define JOB_POOL_MAX_WORKERS 256
+
+typedef void (*JobFunc)(void *context, int64_t index, int worker);
+
+typedef struct JobPool JobPool;
+
+JobPool *createJobPool(int workers);
+void destroyJobPool(JobPool *pool);
+int jobPoolWorkers(const JobPool *pool);
+void jobPoolRun(JobPool *pool, int64_t count, int64_t grain, JobFunc func, void *context);
+int hardwareThreads(void);
+
+#endif
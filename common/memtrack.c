@@ -0,0 +1,234 @@
+#ifdef MEMTRACK_ENABLED
+
+#include "memtrack.h"
+
+#include <stdatomic.h>
+#include <string.h>
+
+#define BLOCK_MAGIC 0x4d454d54u
+
+static const char *tagNames[MEM_TAG_COUNT] = {"general", "sim", "particles", "render", "assets", "textures", "audio", "jobs", "raylib"};
+
+// Sits in front of every block; 16 bytes keeps malloc's alignment
+typedef struct BlockHeader
+{
+    uint64_t size;
+    uint32_t tag;
+    uint32_t magic;
+} BlockHeader;
+
+// Counters are updated from the loader and job threads too, so everything is
+// atomic; peaks are raised with a compare-exchange loop
+static atomic_int_fast64_t liveBytes[MEM_TAG_COUNT];
+static atomic_int_fast64_t peakBytes[MEM_TAG_COUNT];
+static atomic_int_fast64_t liveBlocks[MEM_TAG_COUNT];
+static atomic_int_fast64_t allocations[MEM_TAG_COUNT];
+static atomic_int_fast64_t totalLive;
+static atomic_int_fast64_t totalPeak;
+static atomic_int_fast64_t frameAllocations;
+static int64_t lastFrameAllocations;
+static bool overlayVisible;
+static _Thread_local int threadTag = MEM_RAYLIB;
+
+static void raisePeak(atomic_int_fast64_t *peak, int64_t value)
+{
+    int64_t seen = atomic_load_explicit(peak, memory_order_relaxed);
+    while (value > seen && !atomic_compare_exchange_weak_explicit(peak, &seen, value, memory_order_relaxed, memory_order_relaxed))
+        ;
+}
+
+static void account(int tag, int64_t bytes, int64_t blocks)
+{
+    int64_t live = atomic_fetch_add_explicit(&liveBytes[tag], bytes, memory_order_relaxed) + bytes;
+    int64_t total = atomic_fetch_add_explicit(&totalLive, bytes, memory_order_relaxed) + bytes;
+    atomic_fetch_add_explicit(&liveBlocks[tag], blocks, memory_order_relaxed);
+    if (bytes > 0)
+    {
+        raisePeak(&peakBytes[tag], live);
+        raisePeak(&totalPeak, total);
+    }
+    if (blocks > 0)
+    {
+        atomic_fetch_add_explicit(&allocations[tag], 1, memory_order_relaxed);
+        atomic_fetch_add_explicit(&frameAllocations, 1, memory_order_relaxed);
+    }
+}
+
+static void *track(BlockHeader *block, size_t size, int tag)
+{
+    if (!block)
+        return 0;
+    if (tag < 0 || tag >= MEM_TAG_COUNT)
+        tag = MEM_GENERAL;
+    block->size = size;
+    block->tag = (uint32_t)tag;
+    block->magic = BLOCK_MAGIC;
+    account(tag, (int64_t)size, 1);
+    return block + 1;
+}
+
+void *memAlloc(size_t size, int tag)
+{
+    if (size > SIZE_MAX - sizeof(BlockHeader))
+        return 0;
+    return track(malloc(sizeof(BlockHeader) + size), size, tag);
+}
+
+void *memCalloc(size_t count, size_t size, int tag)
+{
+    if (size && count > (SIZE_MAX - sizeof(BlockHeader)) / size)
+        return 0;
+    return track(calloc(1, sizeof(BlockHeader) + count * size), count * size, tag);
+}
+
+void *memRealloc(void *ptr, size_t size, int tag)
+{
+    if (!ptr)
+        return memAlloc(size, tag);
+    if (size > SIZE_MAX - sizeof(BlockHeader))
+        return 0;
+    BlockHeader *old = (BlockHeader *)ptr - 1;
+    if (old->magic != BLOCK_MAGIC)
+        return realloc(ptr, size);
+    BlockHeader copy = *old;
+    BlockHeader *block = realloc(old, sizeof(BlockHeader) + size);
+    if (!block)
+        return 0;
+    // A resize moves bytes within the tag but is still an allocation
+    account((int)copy.tag, (int64_t)size - (int64_t)copy.size, 0);
+    atomic_fetch_add_explicit(&frameAllocations, 1, memory_order_relaxed);
+    block->size = size;
+    return block + 1;
+}
+
+void memFree(void *ptr)
+{
+    if (!ptr)
+        return;
+    BlockHeader *block = (BlockHeader *)ptr - 1;
+    // With the raylib hook a library can hand over memory from plain malloc
+    if (block->magic != BLOCK_MAGIC)
+    {
+        free(ptr);
+        return;
+    }
+    account((int)block->tag, -(int64_t)block->size, -1);
+    block->magic = 0;
+    free(block);
+}
+
+// The header sits right before the aligned block as usual, with malloc's own
+// pointer stored just in front of it for memAlignedFree
+void *memAlignedAlloc(size_t size, size_t alignment, int tag)
+{
+    size_t extra = sizeof(void *) + sizeof(BlockHeader) + alignment - 1;
+    if (size > SIZE_MAX - extra)
+        return 0;
+    unsigned char *raw = malloc(extra + size);
+    if (!raw)
+        return 0;
+    uintptr_t user = ((uintptr_t)raw + sizeof(void *) + sizeof(BlockHeader) + alignment - 1) & ~(uintptr_t)(alignment - 1);
+    BlockHeader *block = (BlockHeader *)user - 1;
+    memcpy((unsigned char *)block - sizeof(void *), &raw, sizeof(void *));
+    return track(block, size, tag);
+}
+
+void memAlignedFree(void *ptr)
+{
+    if (!ptr)
+        return;
+    BlockHeader *block = (BlockHeader *)ptr - 1;
+    void *raw;
+    memcpy(&raw, (unsigned char *)block - sizeof(void *), sizeof(void *));
+    account((int)block->tag, -(int64_t)block->size, -1);
+    block->magic = 0;
+    free(raw);
+}
+
+int memtrackPushTag(int tag)
+{
+    int previous = threadTag;
+    threadTag = tag;
+    return previous;
+}
+
+void memtrackPopTag(int previous)
+{
+    threadTag = previous;
+}
+
+void *memtrackRaylibAlloc(size_t size)
+{
+    return memAlloc(size, threadTag);
+}
+
+void *memtrackRaylibCalloc(size_t count, size_t size)
+{
+    return memCalloc(count, size, threadTag);
+}
+
+void *memtrackRaylibRealloc(void *ptr, size_t size)
+{
+    return memRealloc(ptr, size, threadTag);
+}
+
+void memtrackRaylibFree(void *ptr)
+{
+    memFree(ptr);
+}
+
+void memtrackEndFrame(void)
+{
+    lastFrameAllocations = atomic_exchange_explicit(&frameAllocations, 0, memory_order_relaxed);
+}
+
+int64_t memtrackFrameAllocations(void)
+{
+    return lastFrameAllocations;
+}
+
+void memtrackTagStats(int tag, MemTagStats *stats)
+{
+    stats->liveBytes = atomic_load_explicit(&liveBytes[tag], memory_order_relaxed);
+    stats->peakBytes = atomic_load_explicit(&peakBytes[tag], memory_order_relaxed);
+    stats->liveBlocks = atomic_load_explicit(&liveBlocks[tag], memory_order_relaxed);
+    stats->allocations = atomic_load_explicit(&allocations[tag], memory_order_relaxed);
+}
+
+void memtrackTotals(int64_t *live, int64_t *peak)
+{
+    *live = atomic_load_explicit(&totalLive, memory_order_relaxed);
+    *peak = atomic_load_explicit(&totalPeak, memory_order_relaxed);
+}
+
+const char *memtrackTagName(int tag)
+{
+    return tagNames[tag];
+}
+
+bool memtrackReportLeaks(FILE *out)
+{
+    bool clean = true;
+    for (int tag = 0; tag < MEM_TAG_COUNT; tag++)
+    {
+        MemTagStats stats;
+        memtrackTagStats(tag, &stats);
+        if (stats.liveBlocks == 0)
+            continue;
+        fprintf(out, "memtrack: %lld bytes in %lld blocks still live in %s\n", (long long)stats.liveBytes, (long long)stats.liveBlocks, tagNames[tag]);
+        clean = false;
+    }
+    return clean;
+}
+
+void memtrackToggleOverlay(void)
+{
+    overlayVisible = !overlayVisible;
+}
+
+bool memtrackOverlayVisible(void)
+{
+    return overlayVisible;
+}
+
+#endif
@@ -0,0 +1,114 @@
+#ifndef MEMTRACK_H
+#define MEMTRACK_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// Allocation tracker. Build with MEMTRACK_ENABLED to count live and peak
+// bytes per subsystem tag, allocations per frame and blocks still live at
+// exit; without it memAlloc and friends are plain malloc/free inlines.
+
+enum MemTag
+{
+    MEM_GENERAL,
+    MEM_SIM,
+    MEM_PARTICLES,
+    MEM_RENDER,
+    MEM_ASSETS,
+    MEM_TEXTURES,
+    MEM_AUDIO,
+    MEM_JOBS,
+    MEM_RAYLIB,
+    MEM_TAG_COUNT
+};
+
+typedef struct MemTagStats
+{
+    int64_t liveBytes;
+    int64_t peakBytes;
+    int64_t liveBlocks;
+    int64_t allocations;
+} MemTagStats;
+
+#ifdef MEMTRACK_ENABLED
+
+void *memAlloc(size_t size, int tag);
+void *memCalloc(size_t count, size_t size, int tag);
+// A block keeps the tag it was first allocated with
+void *memRealloc(void *ptr, size_t size, int tag);
+void memFree(void *ptr);
+// For blocks that need more than malloc's alignment; alignment must be a
+// power of two. Free them with memAlignedFree only.
+void *memAlignedAlloc(size_t size, size_t alignment, int tag);
+void memAlignedFree(void *ptr);
+
+// Tag for untagged allocations made on this thread, such as raylib's when
+// it is built with the hook; returns the previous one for memtrackPopTag
+int memtrackPushTag(int tag);
+void memtrackPopTag(int previous);
+// raylib's RL_MALLOC family, see MEMTRACK_RAYLIB in CMakeLists.txt
+void *memtrackRaylibAlloc(size_t size);
+void *memtrackRaylibCalloc(size_t count, size_t size);
+void *memtrackRaylibRealloc(void *ptr, size_t size);
+void memtrackRaylibFree(void *ptr);
+
+void memtrackEndFrame(void);
+// Allocations made during the last finished frame
+int64_t memtrackFrameAllocations(void);
+void memtrackTagStats(int tag, MemTagStats *stats);
+void memtrackTotals(int64_t *liveBytes, int64_t *peakBytes);
+const char *memtrackTagName(int tag);
+// Lists every tag with blocks still live; returns false if there were any
+bool memtrackReportLeaks(FILE *out);
+void memtrackToggleOverlay(void);
+bool memtrackOverlayVisible(void);
+void drawMemtrackOverlay(int x, int y);
+
+#else
+
+static inline void *memAlloc(size_t size, int tag)
+{
+    (void)tag;
+    return malloc(size);
+}
+static inline void *memCalloc(size_t count, size_t size, int tag)
+{
+    (void)tag;
+    return calloc(count, size);
+}
+static inline void *memRealloc(void *ptr, size_t size, int tag)
+{
+    (void)tag;
+    return realloc(ptr, size);
+}
+static inline void memFree(void *ptr) { free(ptr); }
+static inline void *memAlignedAlloc(size_t size, size_t alignment, int tag)
+{
+    (void)tag;
+    // aligned_alloc wants the size to be a multiple of the alignment
+    return aligned_alloc(alignment, (size + alignment - 1) & ~(alignment - 1));
+}
+static inline void memAlignedFree(void *ptr) { free(ptr); }
+static inline int memtrackPushTag(int tag)
+{
+    (void)tag;
+    return 0;
+}
+static inline void memtrackPopTag(int previous) { (void)previous; }
+static inline void memtrackEndFrame(void) {}
+static inline int64_t memtrackFrameAllocations(void) { return 0; }
+static inline bool memtrackReportLeaks(FILE *out)
+{
+    (void)out;
+    return true;
+}
+static inline void memtrackToggleOverlay(void) {}
+static inline bool memtrackOverlayVisible(void) { return false; }
+static inline void drawMemtrackOverlay(int x, int y) { (void)x, (void)y; }
+
+#endif
+
+#endif
@@ -0,0 +1,24 @@
+#ifdef MEMTRACK_ENABLED
+
+#include "raylib.h"
+#include "memtrack.h"
+
+void drawMemtrackOverlay(int x, int y)
+{
+    if (!memtrackOverlayVisible())
+        return;
+
+    int64_t live, peak;
+    memtrackTotals(&live, &peak);
+    DrawRectangle(x, y, 340, 44 + 20 * MEM_TAG_COUNT, Fade(BLACK, 0.7f));
+    DrawText(TextFormat("live %.1f KiB  peak %.1f KiB  %lld/frame", live / 1024.0, peak / 1024.0, (long long)memtrackFrameAllocations()), x + 8, y + 4, 16, LIGHTGRAY);
+    DrawText("tag           live KiB  peak KiB", x + 8, y + 24, 16, LIGHTGRAY);
+    for (int tag = 0; tag < MEM_TAG_COUNT; tag++)
+    {
+        MemTagStats stats;
+        memtrackTagStats(tag, &stats);
+        DrawText(TextFormat("%-12s %9.1f %9.1f", memtrackTagName(tag), stats.liveBytes / 1024.0, stats.peakBytes / 1024.0), x + 8, y + 44 + 20 * tag, 16, GREEN);
+    }
+}
+
+#endif
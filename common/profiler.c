@@ -0,0 +1,161 @@
+#ifdef PROFILER_ENABLED
+
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 199309L
+#endif
+
+#include "profiler.h"
+
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+static const char *phaseNames[PHASE_COUNT] = {"input", "physics", "collision", "particles", "draw", "present"};
+
+// Single-producer ring: the game thread publishes a finished frame by bumping
+// head, readers trail behind with their own cursor and never block it. A
+// reader that falls a whole ring behind skips ahead and counts the loss.
+static ProfileFrame ring[PROFILE_RING_SIZE];
+static atomic_uint_fast64_t head;
+static uint64_t csvTail;
+static uint64_t dropped;
+static FILE *csvFile;
+static ProfileFrame current;
+static uint64_t started[PHASE_COUNT];
+static bool overlayVisible;
+
+static uint64_t profilerNow(void)
+{
+#if defined(_WIN32)
+    static LARGE_INTEGER frequency;
+    LARGE_INTEGER counter;
+    if (!frequency.QuadPart)
+        QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return (uint64_t)(counter.QuadPart * 1000000000.0 / frequency.QuadPart);
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000u + now.tv_nsec;
+#endif
+}
+
+static void drainCsv(void)
+{
+    uint64_t end = atomic_load_explicit(&head, memory_order_acquire);
+    if (end - csvTail > PROFILE_RING_SIZE)
+    {
+        dropped += end - csvTail - PROFILE_RING_SIZE;
+        csvTail = end - PROFILE_RING_SIZE;
+    }
+    for (; csvTail < end; csvTail++)
+    {
+        const ProfileFrame *frame = &ring[csvTail % PROFILE_RING_SIZE];
+        fprintf(csvFile, "%llu", (unsigned long long)frame->frame);
+        for (int p = 0; p < PHASE_COUNT; p++)
+            fprintf(csvFile, ",%u", frame->ns[p]);
+        fputc('\n', csvFile);
+    }
+}
+
+void profilerInit(const char *csvFileName)
+{
+    atomic_store(&head, 0);
+    csvTail = 0;
+    dropped = 0;
+    memset(&current, 0, sizeof(current));
+    csvFile = 0;
+    if (csvFileName)
+    {
+        csvFile = fopen(csvFileName, "w");
+        if (csvFile)
+        {
+            fputs("frame", csvFile);
+            for (int p = 0; p < PHASE_COUNT; p++)
+                fprintf(csvFile, ",%s_ns", phaseNames[p]);
+            fputc('\n', csvFile);
+        }
+    }
+}
+
+void profilerShutdown(void)
+{
+    if (!csvFile)
+        return;
+    drainCsv();
+    if (dropped)
+        fprintf(stderr, "profiler: %llu frames dropped from CSV\n", (unsigned long long)dropped);
+    fclose(csvFile);
+    csvFile = 0;
+}
+
+void profilerBegin(int phase)
+{
+    started[phase] = profilerNow();
+}
+
+// Phases can run several times a frame (one per physics tick), so time adds up
+void profilerEnd(int phase)
+{
+    current.ns[phase] += (uint32_t)(profilerNow() - started[phase]);
+}
+
+void profilerEndFrame(void)
+{
+    uint64_t index = atomic_load_explicit(&head, memory_order_relaxed);
+    current.frame = index;
+    ring[index % PROFILE_RING_SIZE] = current;
+    atomic_store_explicit(&head, index + 1, memory_order_release);
+    memset(&current, 0, sizeof(current));
+
+    if (csvFile && index + 1 - csvTail >= PROFILE_RING_SIZE / 2)
+        drainCsv();
+}
+
+static int compareUint(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+// Rolling percentiles in milliseconds over the last PROFILE_WINDOW frames
+bool profilerPercentiles(int phase, float *p50, float *p99)
+{
+    uint64_t end = atomic_load_explicit(&head, memory_order_acquire);
+    int count = end < PROFILE_WINDOW ? (int)end : PROFILE_WINDOW;
+    if (count == 0)
+        return false;
+
+    uint32_t samples[PROFILE_WINDOW];
+    for (int i = 0; i < count; i++)
+        samples[i] = ring[(end - 1 - i) % PROFILE_RING_SIZE].ns[phase];
+    qsort(samples, count, sizeof(samples[0]), compareUint);
+    *p50 = samples[count / 2] / 1e6f;
+    *p99 = samples[(count * 99) / 100] / 1e6f;
+    return true;
+}
+
+void profilerToggleOverlay(void)
+{
+    overlayVisible = !overlayVisible;
+}
+
+bool profilerOverlayVisible(void)
+{
+    return overlayVisible;
+}
+
+const char *profilerPhaseName(int phase)
+{
+    return phaseNames[phase];
+}
+
+#endif
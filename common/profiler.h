@@ -0,0 +1,66 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Frame-phase profiler. Build with PROFILER_ENABLED to turn it on; without it
+// every PROFILE_* macro expands to nothing and the functions are empty inlines.
+
+enum ProfilePhase
+{
+    PHASE_INPUT,
+    PHASE_PHYSICS,
+    PHASE_COLLISION,
+    PHASE_PARTICLES,
+    PHASE_DRAW,
+    PHASE_PRESENT,
+    PHASE_COUNT
+};
+
+#define PROFILE_RING_SIZE 1024
+#define PROFILE_WINDOW 240
+
+typedef struct ProfileFrame
+{
+    uint64_t frame;
+    uint32_t ns[PHASE_COUNT];
+} ProfileFrame;
+
+#ifdef PROFILER_ENABLED
+
+void profilerInit(const char *csvFileName);
+void profilerShutdown(void);
+void profilerBegin(int phase);
+void profilerEnd(int phase);
+void profilerEndFrame(void);
+bool profilerPercentiles(int phase, float *p50, float *p99);
+void profilerToggleOverlay(void);
+bool profilerOverlayVisible(void);
+const char *profilerPhaseName(int phase);
+void drawProfilerOverlay(int x, int y);
+
+#define PROFILE_BEGIN(phase) profilerBegin(phase)
+#define PROFILE_END(phase) profilerEnd(phase)
+#define PROFILE_END_FRAME() profilerEndFrame()
+
+#else
+
+static inline void profilerInit(const char *csvFileName) { (void)csvFileName; }
+static inline void profilerShutdown(void) {}
+static inline bool profilerPercentiles(int phase, float *p50, float *p99)
+{
+    (void)phase, (void)p50, (void)p99;
+    return false;
+}
+static inline void profilerToggleOverlay(void) {}
+static inline bool profilerOverlayVisible(void) { return false; }
+static inline void drawProfilerOverlay(int x, int y) { (void)x, (void)y; }
+
+#define PROFILE_BEGIN(phase) ((void)0)
+#define PROFILE_END(phase) ((void)0)
+#define PROFILE_END_FRAME() ((void)0)
+
+#endif
+
+#endif
@@ -0,0 +1,21 @@
+#ifdef PROFILER_ENABLED
+
+#include "raylib.h"
+#include "profiler.h"
+
+void drawProfilerOverlay(int x, int y)
+{
+    if (!profilerOverlayVisible())
+        return;
+
+    DrawRectangle(x, y, 260, 24 + 20 * PHASE_COUNT, Fade(BLACK, 0.7f));
+    DrawText("phase        p50 ms   p99 ms", x + 8, y + 4, 16, LIGHTGRAY);
+    for (int p = 0; p < PHASE_COUNT; p++)
+    {
+        float p50 = 0, p99 = 0;
+        profilerPercentiles(p, &p50, &p99);
+        DrawText(TextFormat("%-12s %6.3f   %6.3f", profilerPhaseName(p), p50, p99), x + 8, y + 24 + 20 * p, 16, GREEN);
+    }
+}
+
+#endif